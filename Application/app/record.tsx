@@ -2,7 +2,7 @@ import React, { useEffect, useState, useCallback } from "react";
 import { StyleSheet, Text, TouchableOpacity, View } from "react-native";
 import { SafeAreaView } from "react-native-safe-area-context";
 import { useGlobal } from "../providers/GlobalContext";
-import { convertFile } from "../providers/utils";
+import { convertFile, expandFile } from "../providers/utils";
 import { File, Paths } from 'expo-file-system';
 import * as Sharing from 'expo-sharing';
 
@@ -80,6 +80,7 @@ export default function Record() {
   const [output, setOutput] = useState("");
   const [playStatus, setPlayStatus] = useState<string | null>(null);
   const [graphData, setGraphData] = useState<number[]>([]);
+  const [similar, setSimilar] = useState("");
   const { registerEvent, sendData, settings } = useGlobal();
 
   function rssiToHeight(rssi: number) {
@@ -105,7 +106,7 @@ export default function Record() {
 
       const file = new File(saveNow ? Paths.document : Paths.cache, 'BKFZ_Recording_' + Date.now() + '.sub');
       file.create();
-      file.write(output);
+      file.write(expandFile(output)); // Flipper Zero plays RAW_Data once, so the trimmed frame is repeated
       
       if (saveNow) {
         alert('Your recording has been saved to your documents folder as ' + file.name + '.');
@@ -131,6 +132,7 @@ export default function Record() {
         for (const sample of data.samples) {
           duration += Math.abs(sample) / 1000; // each unit represents 1 microsecond
         }
+        duration *= data.repeat; // trimmed recordings are looped on the device
 
         setTimeout(() => {
           setPlayStatus(null);
@@ -146,7 +148,8 @@ export default function Record() {
         samples: JSON.stringify(data.samples),
         frequency: data.frequency,
         length: data.samples.length,
-        preset: data.preset
+        preset: data.preset,
+        repeat: data.repeat
       }
     });
 
@@ -158,6 +161,14 @@ export default function Record() {
       if (res.data?.samples) {
         setOutput(res.data.samples);
         setShowAfter(true);
+
+        if (res.data.similar?.length > 0) {
+          // the device already captured something like this (closest match first)
+          const closest = res.data.similar[0];
+          setSimilar(res.data.duplicate ? `Looks like a duplicate of capture #${closest.id}.` : `Similar to capture #${closest.id} (${closest.distance} bits apart).`);
+        } else {
+          setSimilar(""); // don't keep the match of an earlier recording
+        }
       }
 
       if (res.data?.length) {
@@ -214,6 +225,7 @@ export default function Record() {
             <Text style={styles.buttonText}>{playStatus === 'waiting' ? "Sending Data..." : playStatus === 'playing' ? "Replaying..." : "Replay Test"}</Text>
           </TouchableOpacity>
           <Text style={styles.status}>Your recording has been successfully created.</Text>
+          {similar ? <Text style={styles.status}>{similar}</Text> : null}
         </>
       )}
     </SafeAreaView>
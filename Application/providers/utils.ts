@@ -3,6 +3,7 @@ export function convertFile(data: string) {
     const samplesArray = [];
     let frequency = 0;
     let preset = "";
+    let repeat = 1;
     const lines = data.split("\n");
 
     for (let i = 0; i < lines.length; i++) {
@@ -16,7 +17,12 @@ export function convertFile(data: string) {
             preset = preset.replaceAll('FuriHalSubGhzPresetOok270Async', 'AM270');
             preset = preset.replaceAll('FuriHalSubGhzPresetOok650Async', 'AM650');
             preset = preset.replaceAll('FuriHalSubGhzPreset2FSKDev238Async', 'FM238');
-            preset = preset.replaceAll('FuriHalSubGhzPreset2FSKDev238Async', 'FM476');
+            preset = preset.replaceAll('FuriHalSubGhzPreset2FSKDev476Async', 'FM476');
+        }
+
+        if (lines[i].includes("# Repeat:")) {
+            const count = parseInt(lines[i].split("# Repeat:")[1]); // RAW_Data holds one frame that is looped
+            repeat = count > 1 ? count : 1; // a missing or broken count plays the frame once
         }
 
         if (lines[i].includes("RAW_Data:")) {
@@ -31,6 +37,26 @@ export function convertFile(data: string) {
     return {
         samples: samplesArray,
         frequency: frequency,
-        preset: preset
+        preset: preset,
+        repeat: repeat
     };
-}
\ No newline at end of file
+}
+
+// Writes the frame of a trimmed recording out as many times as it was captured (the Flipper Zero ignores # Repeat:)
+export function expandFile(data: string) {
+    const file = convertFile(data);
+    if (file.repeat <= 1) return data;
+
+    const lines = data.split("\n").filter(line => !line.includes("# Repeat:") && !line.includes("RAW_Data:"));
+    const frame = file.samples.filter(sample => !isNaN(sample));
+    const samples: number[] = [];
+    for (let r = 0; r < file.repeat; r++) {
+        samples.push(...frame);
+    }
+
+    for (let i = 0; i < samples.length; i += 512) {
+        lines.push("RAW_Data: " + samples.slice(i, i + 512).join(" "));
+    }
+
+    return lines.join("\n");
+}
@@ -9,11 +9,24 @@
 #include <headers/user_settings.h> // default user settings and their options
 #include <headers/interface.h> // interface for play, analyzer, settings, websockets, etc.
 #include <headers/globals.h> // global variables used across multiple files
+#include <headers/decoder.h> // decodes common fixed-code protocols from the capture stream
+#include <headers/processing.h> // post-capture processing (smoothing, repeat detection, SUB export)
+#include <headers/metrics.h> // counters and histograms served at /api/metrics
+#include <headers/sniff.h> // duty-cycled RX w/ CC1101 Wake-on-Radio
+#include <headers/radio.h> // SPI bus sharing between multiple CC1101 modules
+#include <headers/fingerprint.h> // near-duplicate search over previous captures
+#include <headers/commands.h> // the finished recording is sent from the command arena
+#include <LittleFS.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <mutex>
+#include <atomic>
 
 int samples[MAX_SAMPLES];
 int tempSmooth[MAX_SAMPLES];
 volatile int sampleIndex = 0;
 volatile unsigned long lastTime = 0;
+volatile int captureRssi = -200; // last RSSI the interrupt read, kept while another radio is using the SPI bus
 
 // -- Recording Graph Data -- //
 int itemsToGraph[1024];
@@ -22,57 +35,211 @@ volatile int graphSkipped = 0;
 volatile int graphIndex = -1;
 volatile int lastSend = 0;
 
-// Updates the settings for the CC1101 (utilizes user settings)
-void setupCC1101(bool transmit, int retry = false) {
-  ELECHOUSE_cc1101.setSpiPin(SCK_CPIN, MISO_CPIN, MOSI_CPIN, CSN_CPIN);
+// -- Protocol Decoder -- //
+Decoder decoder;
+int decodedIndex = 0; // samples before this index were already fed to the decoder
+std::mutex decoderLock; // fed by loop(), flushed by whichever task stops the recording
+
+// -- Capture Index -- //
+Fingerprint fingerprints[FINGERPRINT_MAX_ENTRIES];
+int fingerprintCount = -1; // -1 until the index was read from flash
+uint32_t nextCaptureId = 0;
+
+// -- Sniff Mode -- //
+int sniffInterval = SNIFF_INTERVAL_MS;
+int sniffRxTime = SNIFF_RX_TIME;
+
+// -- Replay -- //
+volatile bool playing = false; // set while playSignal() transmits on the recording radio
+
+// True while a capture, sniff or replay is using the recording radio
+bool recordRadioBusy() {
+  return playing || status.record == "RUNNING" || status.sniff != "IDLE";
+}
+
+// Applies the user settings to a CC1101 module, the caller has to hold its RadioLock (returns false if it didn't answer)
+bool configureCC1101(int radio, bool transmit, int frequency) {
   ELECHOUSE_cc1101.Init();
-  ELECHOUSE_cc1101.setMHZ(settings.frequency / 1000000.0);
+  ELECHOUSE_cc1101.setMHZ(frequency / 1000000.0);
 
   if(transmit) {
-    pinMode(GDO0_CPIN, OUTPUT);
+    pinMode(RADIOS[radio].gdo0, OUTPUT);
     ELECHOUSE_cc1101.SetTx(); // Enables transmit mode (used for sending)
   } else {
-    pinMode(GDO2_CPIN, INPUT);
+    pinMode(RADIOS[radio].gdo2, INPUT);
     ELECHOUSE_cc1101.SetRx(); // Enables receive mode (used for listening)
   }
 
   const Preset* preset = findPreset(settings.preset);
   applyConfiguration(preset->data, preset->length);
-  
-  if(!ELECHOUSE_cc1101.getCC1101()) {
+  return ELECHOUSE_cc1101.getCC1101();
+}
+
+// Updates the settings for a CC1101 module (utilizes user settings, the analyzer passes its hopper frequency)
+void setupCC1101(int radio, bool transmit, int frequency, int retry = false) {
+  bool connected;
+
+  {
+    RadioLock lock(radio);
+    connected = configureCC1101(radio, transmit, frequency);
+  }
+
+  if(!connected) {
     if(!retry) {
       Serial.println(F("Connection error with CC1101, retrying..."));
-      setupCC1101(transmit, true);
+      setupCC1101(radio, transmit, frequency, true);
     } else {
       Serial.println(F("Failed CC1101 connection retry. Please check your pins."));
     }
   }
 }
 
-// Enables receiver mode and records RAW samples
-void startRecording() {
-  setupCC1101(false); // Initizalize CC1101 with receiver mode
+// Starts capturing w/ the CC1101 already in receiver mode (the sample buffers have to be flushed already)
+void armCapture() {
   status.record = "RUNNING";
   
   // Update all of the pins and setup interrupt
+  captureRssi = -200; // below every threshold until the interrupt got the bus once
+  {
+    std::lock_guard<std::mutex> lock(decoderLock);
+    resetDecoder(decoder);
+    decodedIndex = 0;
+  }
+  attachInterrupt(digitalPinToInterrupt(RADIOS[RADIO_RECORD].gdo2), onSignalChange, CHANGE);
+}
+
+// Enables receiver mode and records RAW samples
+void startRecording() {
+  status.record = "RUNNING"; // claims the radio before it's configured (a shared analyzer checks this)
   flushSamples();
-  attachInterrupt(digitalPinToInterrupt(GDO2_CPIN), onSignalChange, CHANGE);
+  setupCC1101(RADIO_RECORD, false, settings.frequency); // Initizalize CC1101 with receiver mode
+  armCapture();
 }
 
 // Stops recording and checks if successful
 void stopRecording() {
-  detachInterrupt(digitalPinToInterrupt(GDO2_CPIN));
+  detachInterrupt(digitalPinToInterrupt(RADIOS[RADIO_RECORD].gdo2));
   status.record = "IDLE";
+  decodeSamples(true); // the last frame has no gap after it
+}
+
+// Stops recording, processes the samples and sends the finished SUB file
+void finishRecording() {
+  stopRecording();
+  Serial.print(F("Found "));
+  Serial.print(String(sampleIndex));
+  Serial.print(F(" RAW samples, smoothing needed."));
+  delay(100);
+  smoothenSamples();
+  Serial.println(F("Recording has been successfully finished and samples have been smoothened."));
+
+  FingerprintMatch similar[3];
+  uint32_t captureId;
+  const int similarCount = indexCapture(similar, 3, captureId); // before trimming, every repeat adds to the fingerprint
+
+  int repeat = trimRepeats();
+  String result = samplesToSub(repeat);
+
+  sendRecordResult(result, repeat, captureId, similar, min(similarCount, 3));
+  flushSamples(); // flush the samples array once data was transmitted
+}
+
+// Waits until the CC1101 senses a carrier (GDO2 high), returns false if sniffing was stopped first
+bool waitForCarrier() {
+  const int pin = RADIOS[RADIO_RECORD].gdo2;
+
+  while (status.sniff == "RUNNING") {
+    if (digitalRead(pin) == HIGH) return true;
+
+    if (SNIFF_LIGHT_SLEEP) {
+      gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_HIGH_LEVEL);
+      esp_sleep_enable_gpio_wakeup();
+      esp_sleep_enable_timer_wakeup(1000000); // wake up every second to check if sniffing was stopped
+      esp_light_sleep_start();
+      gpio_wakeup_disable((gpio_num_t)pin);
+    } else {
+      delay(1); // lets the idle task run (the CPU halts until the next tick)
+    }
+  }
+
+  return false;
+}
+
+// Duty-cycled recording, the CC1101 polls the channel on its own and every burst it hears is captured
+void sniffSignals() {
+  status.sniff = "RUNNING";
+  const SniffSchedule schedule = sniffSchedule(sniffInterval, sniffRxTime);
+
+  Serial.printf("[SNIFF]: listening %.2fms every %.1fms (%.2f%% duty), about %.2fmA average.\n",
+    schedule.rxMs, schedule.intervalMs, schedule.dutyCycle * 100, sniffCurrent(schedule, SNIFF_LIGHT_SLEEP));
+
+  setupCC1101(RADIO_RECORD, false, settings.frequency);
+  flushSamples(); // every capture below leaves the buffers flushed for the next wake
+
+  while (status.sniff == "RUNNING") {
+    startSniff(schedule);
+    if (!waitForCarrier()) break;
+
+    // Go straight into RX and attach the interrupt. There is no pre-trigger: GDO2 only signals carrier sense while the
+    // CC1101 sniffs and nothing is buffered before the wake, so the start of the first frame is lost (remotes repeat it)
+    const unsigned long woke = micros();
+    stopSniff();
+    armCapture();
+    metrics.sniffWakes++;
+    recordHistogram(metrics.wakeToCapture, micros() - woke);
+
+    // Capture until no edge was accepted for a while (rejected edges are noise) or the buffer is full
+    int accepted = sampleIndex;
+    unsigned long quietSince = woke;
+    while (status.sniff == "RUNNING" && status.record == "RUNNING" && sampleIndex < MAX_SAMPLES) {
+      if (sampleIndex != accepted) {
+        accepted = sampleIndex;
+        quietSince = micros();
+      }
+      if (micros() - quietSince > SNIFF_QUIET_MS * 1000UL) break;
+
+      decodeSamples(false);
+      if (graphUpdateNeeded) {
+        graphUpdateNeeded = false;
+        checkGraph();
+      }
+      delay(1);
+    }
+
+    // Only a real burst becomes a recording, a false wake (too few edges for a frame) goes straight back to sniffing
+    if (status.record == "RUNNING" && sampleIndex >= SNIFF_MIN_EDGES) {
+      finishRecording(); // flushes the buffers for the next wake
+    } else {
+      stopRecording();
+      flushSamples();
+      metrics.sniffFalseWakes++;
+    }
+  }
+
+  stopSniff();
+  status.sniff = "IDLE";
+  Serial.println(F("Sniff mode has been stopped by the user."));
 }
 
 // Capture and analyze nearby frequencies w/ RSSI
 
 void frequencyAnalyzer() {
+  // Configured once, every hop only retunes (w/ one module it would retune in the middle of a capture or replay)
+  {
+    RadioLock lock(RADIO_ANALYZER);
+    if (RADIO_ANALYZER == RADIO_RECORD && recordRadioBusy()) {
+      status.detect = "IDLE";
+      Serial.println(F("Frequency analyzer can't be started while the only CC1101 is recording or playing."));
+      return;
+    }
+
+    configureCC1101(RADIO_ANALYZER, false, hopperFrequenciesUSA[0]);
+  }
+
   status.detect = "RUNNING";
   Serial.println(F("Frequency analyzer has been started by the user (watch for websockets)."));
 
-  // Store old settings to revert when done and last seen frequency/RSSI
-  int old_freq = settings.frequency;
+  // Last seen frequency/RSSI
   int lastFrequency = 0;
   int lastRSSI = 0;
 
@@ -81,10 +248,28 @@ void frequencyAnalyzer() {
     int strongestFreq = 0;
 
     for(int frequency : hopperFrequenciesUSA) {
-      settings.frequency = frequency; // Update to hopper frequency
-      setupCC1101(false);
+      const unsigned long hopStarted = micros();
+      {
+        RadioLock lock(RADIO_ANALYZER);
+        if (RADIO_ANALYZER == RADIO_RECORD && recordRadioBusy()) {
+          status.detect = "IDLE"; // a capture or replay took over the radio
+          Serial.println(F("Frequency analyzer has been stopped, the only CC1101 is now recording or playing."));
+          break;
+        }
+
+        ELECHOUSE_cc1101.SpiStrobe(CC1101_SIDLE);
+        ELECHOUSE_cc1101.setMHZ(frequency / 1000000.0); // Update to hopper frequency
+        ELECHOUSE_cc1101.SpiStrobe(CC1101_SRX); // calibrates on the way into RX (MCSM0)
+      }
+      recordHistogram(metrics.hopSettle, micros() - hopStarted);
 
-      int rssi = ELECHOUSE_cc1101.getRssi(); // Get the current RSSI
+      delay(1); // the bus is free for the capture interrupt while the RSSI settles
+
+      int rssi;
+      {
+        RadioLock lock(RADIO_ANALYZER);
+        rssi = ELECHOUSE_cc1101.getRssi(); // Get the current RSSI
+      }
 
       // This signal is stronger than the one before and within threshold
       if(rssi >= highestRssi && rssi >= settings.detect_rssi) {
@@ -93,9 +278,13 @@ void frequencyAnalyzer() {
       }
     }
 
+    if (status.detect != "RUNNING") break; // stopped mid-sweep, the hits so far are partial
+
+    metrics.analyzerSweeps++;
+
     // If the signal is unique compared to last time, send through websocket
     if(strongestFreq != lastFrequency && highestRssi != lastRSSI && (strongestFreq != 0 && highestRssi != -INFINITY)) {
-      DynamicJsonDocument doc(128);
+      JsonDocument doc;
       doc["url"] = "/analyzer";
       doc["data"]["freq"] = String(strongestFreq);
       doc["data"]["rssi"] = String(highestRssi);
@@ -107,148 +296,124 @@ void frequencyAnalyzer() {
       lastFrequency = strongestFreq;
       lastRSSI = highestRssi;
 
-      sendData(jsonString);
+      sendData(jsonString, TOPIC_ANALYZER);
       jsonString.clear(); // clean up json string
     }
   }
 
-  // Revert settings back to original and run setup
-  settings.frequency = old_freq;
   Serial.println(F("Frequency analyzer has been stopped by the user."));
 }
 
-// Play a signal from client-side file
-void playSignal(const int reqSamples[], int reqLength) {
+// Play a signal from client-side file (trimmed files are looped to restore their repeats)
+void playSignal(const int reqSamples[], int reqLength, int repeat) {
   Serial.println(F("Now transmitting requested samples..."));
-  setupCC1101(true);
+  playing = true;
+  setupCC1101(RADIO_RECORD, true, settings.frequency);
+  const int pin = RADIOS[RADIO_RECORD].gdo0;
 
   // Transmit all of the sample data
-  for (int i = 0; i < reqLength; i++) {
-    if (reqSamples[i] > 0) {
-      digitalWrite(GDO0_CPIN, HIGH);
-    } else {
-      digitalWrite(GDO0_CPIN, LOW);
+  unsigned long expected = 0;
+  const unsigned long started = micros();
+
+  for (int r = 0; r < repeat; r++) {
+    for (int i = 0; i < reqLength; i++) {
+      if (reqSamples[i] > 0) {
+        digitalWrite(pin, HIGH);
+      } else {
+        digitalWrite(pin, LOW);
+      }
+      delayMicroseconds(abs(reqSamples[i]));
+      expected += abs(reqSamples[i]);
     }
-    delayMicroseconds(abs(reqSamples[i]));
   }
+
+  playing = false;
+  const unsigned long elapsed = micros() - started;
+  recordHistogram(metrics.replayError, elapsed > expected ? elapsed - expected : expected - elapsed);
 }
 
-// Smoothens out the RAW samples to correct format (not written by me!)
+// Smoothens out the RAW samples to correct format
 void smoothenSamples() {
-  #define signalstorage 10
-  
-  // Initialize variables for signal storage, counts, and sums
-  int signalanz = 0;
-  int timingdelay[signalstorage];
-  long signaltimings[signalstorage * 2];
-  int signaltimingscount[signalstorage];
-  long signaltimingssum[signalstorage];
-
-  // Initialize signal timings with default values
-  for (int i = 0; i < signalstorage; i++) {
-    signaltimings[i * 2] = 100000;  // Minimum timing
-    signaltimings[i * 2 + 1] = 0;   // Maximum timing
-    signaltimingscount[i] = 0;      // Count of timings in this range
-    signaltimingssum[i] = 0;        // Sum of timings in this range
-  }
-
-  // Group signals into timing ranges
-  for (int p = 0; p < signalstorage; p++) {
-    for (int i = 1; i < sampleIndex; i++) {
-      // Find the minimum timing for the group
-      if (p == 0) {
-        if (samples[i] < signaltimings[p * 2]) {
-          signaltimings[p * 2] = samples[i];
-        }
-      } else {
-        if (samples[i] < signaltimings[p * 2] && samples[i] > signaltimings[p * 2 - 1]) {
-          signaltimings[p * 2] = samples[i];
-        }
-      }
-    }
+  const unsigned long started = micros();
+  sampleIndex = smoothenBuffer(samples, tempSmooth, sampleIndex);
+  recordHistogram(metrics.smoothing, micros() - started);
+}
 
-    // Find the maximum timing for the group
-    for (int i = 1; i < sampleIndex; i++) {
-      if (samples[i] < signaltimings[p * 2] + ERROR_TOLERANCE && samples[i] > signaltimings[p * 2 + 1]) {
-        signaltimings[p * 2 + 1] = samples[i];
-      }
-    }
+// Trims the smoothened samples down to one canonical frame, returns how many times it was repeated
+int trimRepeats() {
+  const unsigned long started = micros();
+  const int oldLength = sampleIndex;
+  int start, frameLength;
 
-    // Count how many samples fall into this timing range and sum their values
-    for (int i = 1; i < sampleIndex; i++) {
-      if (samples[i] >= signaltimings[p * 2] && samples[i] <= signaltimings[p * 2 + 1]) {
-        signaltimingscount[p]++;
-        signaltimingssum[p] += samples[i];
-      }
-    }
+  int repeat = findRepeatedFrame(samples, sampleIndex, start, frameLength);
+  if (repeat > 1) {
+    memmove(samples, samples + start, frameLength * sizeof(int));
+    sampleIndex = frameLength;
   }
 
-  // Determine how many signal groups are active
-  signalanz = signalstorage;
-  for (int i = 0; i < signalstorage; i++) {
-    if (signaltimingscount[i] == 0) {
-      signalanz = i;
-      break;
-    }
-  }
+  Serial.println("[REPEATS]: " + String(oldLength) + " samples trimmed to " + String(sampleIndex) + " (" + String(repeat) + " repeats) in " + String(micros() - started) + "us.");
+  return repeat;
+}
 
-  // Sort signal groups by count (from most frequent to least frequent)
-  for (int s = 1; s < signalanz; s++) {
-    for (int i = 0; i < signalanz - s; i++) {
-      if (signaltimingscount[i] < signaltimingscount[i + 1]) {
-        // Swap the signal group data
-        int temp1 = signaltimings[i * 2];
-        int temp2 = signaltimings[i * 2 + 1];
-        int temp3 = signaltimingssum[i];
-        int temp4 = signaltimingscount[i];
-
-        signaltimings[i * 2] = signaltimings[(i + 1) * 2];
-        signaltimings[i * 2 + 1] = signaltimings[(i + 1) * 2 + 1];
-        signaltimingssum[i] = signaltimingssum[i + 1];
-        signaltimingscount[i] = signaltimingscount[i + 1];
-
-        signaltimings[(i + 1) * 2] = temp1;
-        signaltimings[(i + 1) * 2 + 1] = temp2;
-        signaltimingssum[i + 1] = temp3;
-        signaltimingscount[i + 1] = temp4;
-      }
-    }
-  }
+// Reads the capture index from flash the first time it's needed
+void loadFingerprints() {
+  if (fingerprintCount >= 0) return;
+  fingerprintCount = 0;
+  if (!ensureFilesystem(FILESYSTEM_WAIT_FOREVER)) return;
 
-  // Calculate average timing for each group
-  for (int i = 0; i < signalanz; i++) {
-    timingdelay[i] = signaltimingssum[i] / signaltimingscount[i];
-  }
+  File file = LittleFS.open(FINGERPRINT_INDEX_PATH, "r");
+  if (!file) return;
 
-  // Correct raw data based on timing groups and assign high/low values
-  bool lastbin = false;  // Tracks whether the last bin was high (false = low, true = high)
-  int smoothCount = 0;
-
-  for (int i = 1; i < sampleIndex; i++) {
-    float r = (float)samples[i] / timingdelay[0];
-    int calculate = r;
-    r = r - calculate;
-    r *= 10;
-    if (r >= 5) {
-      calculate += 1;
-    }
+  while (fingerprintCount < FINGERPRINT_MAX_ENTRIES && file.read((uint8_t*)&fingerprints[fingerprintCount], sizeof(Fingerprint)) == sizeof(Fingerprint)) {
+    nextCaptureId = max(nextCaptureId, fingerprints[fingerprintCount].id + 1);
+    fingerprintCount++;
+  }
 
-    if (calculate > 0) {
-      // Toggle the bin state between high and low
-      lastbin = !lastbin;
+  file.close();
+  metrics.indexEntries = fingerprintCount;
+}
 
-      // Assign positive for high and negative for low
-      tempSmooth[smoothCount] = (lastbin ? 1 : -1) * (calculate * timingdelay[0]);
-      smoothCount++;
+// Looks up similar captures for the smoothened samples and adds them to the index, returns how many were found
+int indexCapture(FingerprintMatch matches[], int maxMatches, uint32_t &id) {
+  loadFingerprints();
+
+  const Fingerprint entry = { fingerprintSamples(samples, sampleIndex), (uint32_t)settings.frequency, nextCaptureId };
+  id = entry.id;
+  if (entry.hash == 0) return 0; // too short to fingerprint
+
+  const unsigned long started = micros();
+  const int found = findSimilar(fingerprints, fingerprintCount, entry, matches, maxMatches);
+  recordHistogram(metrics.indexQuery, micros() - started);
+
+  // The oldest capture is overwritten once the index is full (in RAM and on flash)
+  const int slot = entry.id % FINGERPRINT_MAX_ENTRIES;
+  fingerprints[slot] = entry;
+  if (slot >= fingerprintCount) fingerprintCount = slot + 1;
+  nextCaptureId++;
+  metrics.indexEntries = fingerprintCount;
+
+  if (ensureFilesystem(FILESYSTEM_WAIT_FOREVER)) {
+    File file = LittleFS.open(FINGERPRINT_INDEX_PATH, LittleFS.exists(FINGERPRINT_INDEX_PATH) ? "r+" : "w");
+    if (!file || !file.seek(slot * sizeof(Fingerprint)) || file.write((const uint8_t*)&entry, sizeof(Fingerprint)) != sizeof(Fingerprint)) {
+      metrics.indexWriteErrors++;
+      Serial.println("[INDEX]: capture #" + String(entry.id) + " could not be written to " + FINGERPRINT_INDEX_PATH + " (kept in RAM only).");
     }
+    if (file) file.close();
   }
 
-  // Output smoothed data
-  memset(samples, 0, sizeof(samples)); // Clear just the sample array
-  sampleIndex = smoothCount; // Update sample index to smoothed count
-  for (int i = 0; i < smoothCount; i++) {
-    samples[i] = tempSmooth[i];
-  } 
+  if (found > 0) {
+    Serial.println("[INDEX]: capture #" + String(entry.id) + " is similar to #" + String(matches[0].id) + " (" + String(matches[0].distance) + " bits apart, " + String(found) + " matches).");
+  }
+  return found;
+}
+
+// Converts the samples into the Flipper Zero SUB file format (w/ the current settings), the frame is sent once and the
+// clients write it out repeat times when the file is downloaded
+String samplesToSub(int repeat) {
+  const unsigned long started = micros();
+  String result = buildSubFile(samples, sampleIndex, settings.preset, settings.frequency, repeat, true);
+  recordHistogram(metrics.exporting, micros() - started);
+  return result;
 }
 
 void flushSamples() {
@@ -276,7 +441,7 @@ void checkGraph() {
   if(micros() - lastSend > 100000 && graphIndex >= 1) { // the last time it was updated was >100ms ago
     lastSend = micros();
 
-    DynamicJsonDocument doc(256);
+    JsonDocument doc;
     doc["url"] = "/record";
     JsonArray graphArray = doc["data"]["graph"].to<JsonArray>();
     for (int i = 0; i < graphIndex; ++i) {
@@ -286,7 +451,7 @@ void checkGraph() {
     
     String jsonString;
     serializeJson(doc, jsonString);
-    sendData(jsonString);
+    sendData(jsonString, TOPIC_RECORD_TELEMETRY);
 
     jsonString.clear(); // clean up json string
     memset(itemsToGraph, 0, sizeof(itemsToGraph));
@@ -294,14 +459,57 @@ void checkGraph() {
   }
 }
 
+// Feeds newly captured samples to the decoder and sends any decoded keys (flush once the capture has ended)
+void decodeSamples(bool flush) {
+  std::lock_guard<std::mutex> lock(decoderLock);
+  const int captured = sampleIndex;
+  DecodedSignal decoded;
+
+  while (decodedIndex < captured || flush) {
+    if (decodedIndex < captured) {
+      if (!feedDecoder(decoder, samples[decodedIndex++], decoded)) continue;
+    } else {
+      flush = false;
+      if (!flushDecoder(decoder, decoded)) continue;
+    }
+
+    char key[17];
+    snprintf(key, sizeof(key), "%llX", (unsigned long long)decoded.key);
+
+    JsonDocument doc;
+    doc["url"] = "/record";
+    doc["data"]["decoded"]["protocol"] = decoded.protocol->name;
+    doc["data"]["decoded"]["key"] = key;
+    doc["data"]["decoded"]["bits"] = decoded.bits;
+    doc["data"]["decoded"]["te"] = decoded.te;
+
+    String jsonString;
+    serializeJson(doc, jsonString);
+    sendData(jsonString, TOPIC_RECORD_TELEMETRY);
+
+    Serial.println("[DECODER]: " + String(decoded.protocol->name) + " " + String(decoded.bits) + " bit key 0x" + key + " (te " + String(decoded.te) + "us)");
+  }
+}
+
 // Handle event changes of CC1101
 void onSignalChange() {
   const unsigned long time = micros();
   const unsigned int duration = time - lastTime;
-  int rssi = ELECHOUSE_cc1101.getRssi(); // Get the current RSSI
 
-  if (sampleIndex < MAX_SAMPLES && (rssi >= settings.rssi || settings.rssi == -200)) {
+  if (tryLockRadioFromISR(RADIO_RECORD)) {
+    captureRssi = ELECHOUSE_cc1101.getRssi(); // Get the current RSSI
+    unlockRadioFromISR(RADIO_RECORD);
+  }
+
+  const int rssi = captureRssi;
+
+  if (rssi < settings.rssi && settings.rssi != -200) {
+    metrics.rssiRejects++;
+  } else if (sampleIndex >= MAX_SAMPLES) {
+    metrics.droppedEdges++;
+  } else {
     samples[sampleIndex++] = duration;
+    metrics.edges++;
 
     graphSkipped++;
 
@@ -316,19 +524,87 @@ void onSignalChange() {
   lastTime = time;
 }
 
+// Logs when a boot stage finished (in ms since power on), returns the time for metrics
+uint32_t logBootStage(const char* stage) {
+  const uint32_t now = millis();
+  Serial.printf("[BOOT]: %s after %lums\n", stage, (unsigned long)now);
+  return now;
+}
+
+// Set by filesystemTask once LittleFS was mounted (or couldn't be)
+static EventGroupHandle_t filesystemEvents;
+static const EventBits_t FILESYSTEM_MOUNTED = 1 << 0;
+static const EventBits_t FILESYSTEM_FAILED = 1 << 1;
+
+// Mounts LittleFS on its own task, formatting a blank partition takes seconds and must not block the network task
+void filesystemTask(void* parameter) {
+  if (LittleFS.begin(true)) {
+    logBootStage("LittleFS mounted");
+    xEventGroupSetBits(filesystemEvents, FILESYSTEM_MOUNTED);
+  } else {
+    Serial.println(F("An error has occurred while mounting LittleFS. Please check if LittleFS is properly installed."));
+    xEventGroupSetBits(filesystemEvents, FILESYSTEM_FAILED);
+  }
+
+  vTaskDelete(NULL);
+}
+
+// Starts the mount the first time a page, asset or the capture index is needed (keeps it out of the boot path) and
+// waits up to waitMs for it, safe to call from any task
+bool ensureFilesystem(uint32_t waitMs) {
+  static std::atomic<bool> started(false);
+  if (!started.exchange(true)) {
+    xTaskCreate(filesystemTask, "filesystem", 4096, NULL, 1, NULL);
+  }
+
+  const TickType_t ticks = waitMs == FILESYSTEM_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+  return xEventGroupWaitBits(filesystemEvents, FILESYSTEM_MOUNTED | FILESYSTEM_FAILED, pdFALSE, pdFALSE, ticks) & FILESYSTEM_MOUNTED;
+}
+
+// Brings up the Wi-Fi/BLE interface on the other core while the CC1101 is being configured
+void networkTask(void* parameter) {
+  setupDevice();
+  metrics.networkReadyMs = logBootStage("network ready");
+  vTaskDelete(NULL);
+}
+
+// Owns the analyzer radio, so the band can be watched while loop() records or replays on another module
+void analyzerTask(void* parameter) {
+  for(;;) {
+    if(status.detect == "QUEUED") {
+      frequencyAnalyzer();
+    }
+
+    delay(10);
+  }
+}
+
 void setup() {
-  Serial.begin(9600);
-  delay(500);
-  while (!Serial) { ; }
+  Serial.begin(9600); // never wait for a serial host (battery powered units don't have one)
+  logBootStage("serial started");
+  filesystemEvents = xEventGroupCreate(); // before any task can ask for the filesystem
 
   loadSettings();
-  setupDevice();
-  setupCC1101(false);
+  logBootStage("settings loaded");
+
+  xTaskCreatePinnedToCore(networkTask, "network", 8192, NULL, 1, NULL, 0);
+
+  setupRadios();
+  for(int radio = 0; radio < RADIO_COUNT; radio++) {
+    setupCC1101(radio, false, settings.frequency);
+  }
+  metrics.radioReadyMs = logBootStage("radio ready");
+
+  xTaskCreatePinnedToCore(analyzerTask, "analyzer", 8192, NULL, 1, NULL, 1);
 }
 
 void loop() {
-  if(status.detect == "QUEUED") {
-    frequencyAnalyzer();
+  if(status.sniff == "QUEUED") {
+    sniffSignals();
+  }
+
+  if(status.record == "RUNNING") {
+    decodeSamples(false);
   }
 
   if(graphUpdateNeeded == true) {
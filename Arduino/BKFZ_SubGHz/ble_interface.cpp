@@ -1,16 +1,16 @@
 #include "headers/interface.h"
 #include <headers/config.h> // used to configure basic variables (such as pinout, max samples, etc.)
-static String receivedData = "";
 
 #if CONNECTION_MODE == CONNECTION_MODE_BLE
   #include <BLEDevice.h>
   #include <BLEUtils.h>
   #include <BLEServer.h>
-  #include <ArduinoJson.h>
   #include <BLE2902.h>
 
   #include <headers/user_settings.h> // default user settings and their options
   #include <headers/globals.h> // global variables used across multiple files
+  #include <headers/metrics.h> // counters and histograms sent for /metrics
+  #include <headers/commands.h> // app messages are handled by the shared dispatcher
 
   #define SERVICE_UUID "b1513422-2e10-4528-b293-39409019252f" // random service UUID
   #define TX_CHAR_UUID "cffa88bb-f8ac-423b-9031-0266d4f3aec1" // ESP32 to da app
@@ -19,6 +19,13 @@ static String receivedData = "";
   static bool deviceConnected = false;
   static BLECharacteristic *pTxCharacteristic;
   static BLECharacteristic *pRxCharacteristic;
+
+  // Writes are collected here until the \n end marker (taken from the heap once at boot, a message can't be larger
+  // than what the command arena can parse anyway)
+  constexpr size_t RECEIVE_BUFFER_SIZE = COMMAND_ARENA_SIZE / 2;
+  static char* const receivedData = (char*)malloc(RECEIVE_BUFFER_SIZE);
+  static size_t receivedLength = 0;
+  static bool receivedOverflow = false; // the rest of a message that didn't fit is dropped
   
   class ServerCallbacks: public BLEServerCallbacks {
     void onConnect(BLEServer* pServer) {
@@ -33,7 +40,10 @@ static String receivedData = "";
         Serial.println(F("A websocket user has been disconnected from Frequency Analyzer."));
       }
 
-      if (status.record == "RUNNING") {
+      if (status.sniff != "IDLE") {
+        status.sniff = "IDLE"; // the sniff loop finishes or drops its capture
+        Serial.println(F("A websocket user has been disconnected from Sniff mode."));
+      } else if (status.record == "RUNNING") {
         stopRecording();
         Serial.println(F("A websocket user has been disconnected from Recording."));
       }
@@ -44,193 +54,65 @@ static String receivedData = "";
 
   class RxCallbacks: public BLECharacteristicCallbacks {
     void onWrite(BLECharacteristic *pCharacteristic) {
-      String data = pCharacteristic->getValue().c_str();
-      receivedData += data;
-
-      if (receivedData.endsWith("\n")) {
-        receivedData.trim();
-        data = receivedData;
+      const uint8_t* data = pCharacteristic->getData();
+      const size_t length = pCharacteristic->getLength();
+      if (receivedData == nullptr || length == 0) return;
 
-        receivedData = "";
+      if (receivedLength + length > RECEIVE_BUFFER_SIZE) {
+        receivedOverflow = true;
+        receivedLength = 0;
       } else {
-        return; // wait for more data
+        memcpy(receivedData + receivedLength, data, length);
+        receivedLength += length;
       }
-      
-      if (data.length() > 0) {
-        DynamicJsonDocument doc(MAX_SAMPLES + 1024);
-        deserializeJson(doc, data);
-        JsonObject dataObject = doc["data"]; // Extract the data provided
-
-        if (doc["url"] == "/analyzer") {
-            if (dataObject.containsKey("rssi")) {
-              settings.detect_rssi = dataObject["rssi"].as<int>();
-              Serial.println(F("Updated detect_rssi to "));
-              Serial.print(String(settings.detect_rssi));
-            }
-
-            if (dataObject.containsKey("active")) {
-                if (dataObject["active"] == true) {
-                    status.detect = "QUEUED";
-                } else if (dataObject["active"] == false) {
-                     status.detect = "IDLE";
-                }
-            }
-        }
-
-        if (doc["url"] == "/record") {
-            if (dataObject.containsKey("active")) {
-              if (dataObject["active"] == true) {
-                Serial.println(F("Recording has been successfully started with user settings."));
-                startRecording();
-              } else { 
-                stopRecording();
-                Serial.print(F("Found "));
-                Serial.print(String(sampleIndex));
-                Serial.print(F(" RAW samples, smoothing needed."));
-                delay(100);
-                smoothenSamples();
-                Serial.println(F("Recording has been successfully finished and samples have been smoothened."));
-
-                String prepend = "";
-                String presetName = settings.preset;
-                int freq_format = settings.frequency;
-                presetName.replace("AM270", "FuriHalSubGhzPresetOok270Async");
-                presetName.replace("AM650", "FuriHalSubGhzPresetOok650Async");
-                presetName.replace("FM238", "FuriHalSubGhzPreset2FSKDev238Async");
-                presetName.replace("FM476", "FuriHalSubGhzPreset2FSKDev238Async");
-
-                String result = "Filetype: Flipper SubGhz RAW File\nVersion: 1\n# Created with BKFZ SubGHz\nFrequency: " + String(freq_format) + "\nPreset: " + presetName + "\nProtocol: RAW\nRAW_Data: ";
-
-                if (samples[0] < 0) {
-                  for (int i = 0; i < sampleIndex - 1; ++i) {
-                    samples[i] = samples[i + 1];
-                  }
-                  sampleIndex--;
-                }
-
-                for (int i = 0; i < sampleIndex; ++i) {
-                  String valueToAdd = prepend + String(samples[i]);
-                  result += valueToAdd;
-                  prepend = " ";
-                  if ((i + 1) % 512 == 0) {
-                    result += "\nRAW_Data: ";
-                    prepend = "";
-                  }
-                }
-
-                DynamicJsonDocument responseDoc(MAX_SAMPLES + 1024);
-                responseDoc["url"] = "/record";
-                responseDoc["data"]["success"] = true;
-                responseDoc["data"]["samples"] = result;
-
-                String jsonString;
-                serializeJson(responseDoc, jsonString);
-                sendData(jsonString);
-                jsonString.clear(); // clean up json string
-                flushSamples(); // flush the samples array once data was transmitted
-              }
-            }
-        }
-        
-        if (doc["url"] == "/play") {
-          if (dataObject.containsKey("samples") && dataObject.containsKey("frequency") && dataObject.containsKey("length") && dataObject.containsKey("preset")) {
-            flushSamples(); // free up memory
-
-            String samples = dataObject["samples"].as<String>();
-            int reqLength = dataObject["length"].as<int>();
-            std::vector<int> reqSamples(reqLength);
-
-            // Reconstruct samples array from response
-            DynamicJsonDocument doc(MAX_SAMPLES + 1024);
-            deserializeJson(doc, samples);
-            JsonArray array = doc.as<JsonArray>();
-
-            for (int i = 0; i < reqLength && i < array.size(); i++) {
-                reqSamples[i] = array[i].as<int>();
-            }
-
-            DynamicJsonDocument confirmDoc(128);
-            confirmDoc["url"] = "/play";
-            confirmDoc["data"]["success"] = true;
-
-            String confirmString;
-            serializeJson(confirmDoc, confirmString);
-            sendData(confirmString);
 
-            // Store old settings to revert when done
-            String old_preset = settings.preset;
-            int old_freq = settings.frequency;
+      if (data[length - 1] != '\n') return; // wait for more data
 
-            // Update settings to new data
-            settings.preset = dataObject["preset"].as<String>();
-            settings.frequency = dataObject["frequency"].as<int>();
-            Serial.println(F("Now playing file requested by user, successfully updated to file settings."));
-
-            playSignal(reqSamples.data(), reqLength);
-
-            Serial.println(F("Successfully played file requested, reverting back to old settings."));
-            // Revert settings back to original
-            settings.preset = old_preset;
-            settings.frequency = old_freq;
-          }
-        }
-
-        if (doc["url"] == "/settings") {
-            DynamicJsonDocument confirmDoc(128);
-            confirmDoc["url"] = "/settings";
-            
-            if (dataObject.containsKey("update") && dataObject["update"] == true) {
-                if (dataObject.containsKey("preset")) {
-                    settings.preset = dataObject["preset"].as<String>();
-                }
-
-                if (dataObject.containsKey("frequency")) {
-                    settings.frequency = dataObject["frequency"].as<int>();
-                }
-
-                if (dataObject.containsKey("rssi")) {
-                    settings.rssi = dataObject["rssi"].as<int>();
-                }
-
-                saveSettings(); // Save settings in non-volatile storage
-                confirmDoc["data"]["success"] = true;
-            } else {
-                String setJSON = settingsToJson();
-                String setOptionsJSON = settingsOptionsToJson();
-                String statusJSON = statusToJson();
-
-                confirmDoc["data"]["settings"] = serialized(setJSON);
-                confirmDoc["data"]["options"] = serialized(setOptionsJSON);
-                confirmDoc["data"]["status"] = serialized(statusJSON);
-            }
-
-            confirmDoc["update"] = (dataObject.containsKey("update") && dataObject["update"] == true) ? true : false;
-            String confirmString;
-            serializeJson(confirmDoc, confirmString);
-            sendData(confirmString);
-        }
+      if (receivedOverflow) {
+        metrics.commandErrors++;
+        Serial.println(F("[BLE]: a message was larger than the receive buffer and has been dropped."));
+      } else {
+        dispatchCommand(receivedData, receivedLength - 1, 0); // w/o the end marker
       }
+
+      receivedLength = 0;
+      receivedOverflow = false;
     }
   };
 
-  void sendData(const String &data) {
-    String marked = (data + "\n"); // add \n to serve as the end marker
+  // There is only ever one BLE client (the app), so every topic is delivered to it
+  void subscribeClient(uint32_t client, uint8_t topics) {}
 
+  void sendData(const char* data, size_t length, Topic topic) {
     if (deviceConnected) {
-      const int MTU_SIZE = BLEDevice::getMTU() - 5; // get negotiated MTU size minus overhead (will be capped at the maximum of 145 on iOS devices, and negotiated to 145 on Android devices)
-      int dataLen = marked.length();
+      const size_t dataLen = length + 1; // followed by \n to serve as the end marker
+      metrics.bytesSent += dataLen;
+      metrics.messagesSent++;
+
+      uint8_t chunk[ESP_GATT_MAX_MTU_SIZE];
+      const size_t MTU_SIZE = min((size_t)BLEDevice::getMTU() - 5, sizeof(chunk)); // get negotiated MTU size minus overhead (will be capped at the maximum of 145 on iOS devices, and negotiated to 145 on Android devices)
       
-      for (int i = 0; i < dataLen; i += MTU_SIZE) {
-        int chunkSize = min(MTU_SIZE, dataLen - i);
-        String chunk = marked.substring(i, i + chunkSize);
+      for (size_t i = 0; i < dataLen; i += MTU_SIZE) {
+        const size_t chunkSize = min(MTU_SIZE, dataLen - i);
+        for (size_t j = 0; j < chunkSize; j++) {
+          chunk[j] = i + j < length ? data[i + j] : '\n';
+        }
 
-        pTxCharacteristic->setValue(chunk.c_str());
+        pTxCharacteristic->setValue(chunk, chunkSize);
         pTxCharacteristic->notify();
         delay(10); // small delay to ensure data is sent properly
       }
     }
   }
 
+  void sendData(const String &data, Topic topic) {
+    sendData(data.c_str(), data.length(), topic);
+  }
+
+  void sendDataTo(const char* data, size_t length, uint32_t client) {
+    sendData(data, length, TOPIC_SETTINGS); // the only client is the sender, the topic isn't used over BLE
+  }
+
   void setupDevice() {
     BLEDevice::init("BKFZ SubGHz");
 
@@ -0,0 +1,338 @@
+#include "headers/commands.h"
+#include "headers/interface.h"
+#include <headers/config.h> // used to configure basic variables (such as pinout, max samples, etc.)
+#include <headers/arena.h> // fixed buffer the JSON documents are allocated from
+#include <headers/user_settings.h> // default user settings and their options
+#include <headers/globals.h> // global variables used across multiple files
+#include <headers/metrics.h> // counters and histograms served at /api/metrics
+#include <headers/processing.h> // parseSampleList()
+#include <atomic>
+#include <mutex>
+
+// Every request and reply document lives in this buffer, it's reset for each message so the heap is never touched (taken
+// from the heap once at boot, 48KB more of static DRAM would have to fit next to the BLE stack)
+static uint8_t* const arenaBuffer = (uint8_t*)malloc(COMMAND_ARENA_SIZE);
+static ArenaAllocator arena(arenaBuffer, arenaBuffer != nullptr ? COMMAND_ARENA_SIZE : 0);
+static String replyString; // replies that don't fit in the arena, keeps its capacity between them
+
+// Commands arrive on the transport's task while loop() sends its own results, so only one of them uses the arena at a
+// time (recursive because a command can finish a recording, which replies while the command's document is still alive)
+static std::recursive_mutex arenaLock;
+static int arenaDepth = 0;
+
+// Holds the arena until the end of the scope, only the outermost scope resets it
+class ArenaScope {
+  public:
+    ArenaScope() : lock(arenaLock) {
+      if (arenaDepth++ == 0) arena.reset();
+    }
+
+    ~ArenaScope() {
+      if (--arenaDepth > 0) return;
+
+      metrics.commandArenaPeak = arena.peak;
+      metrics.commandArenaOverflows = arena.overflows;
+    }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope &operator=(const ArenaScope&) = delete;
+
+  private:
+    std::lock_guard<std::recursive_mutex> lock;
+};
+
+// Converts a topic name sent by the client into its topic bit (0 if unknown)
+static uint8_t topicFromName(const char* name) {
+  if (name == nullptr) return 0;
+  if (strcmp(name, "analyzer") == 0) return TOPIC_ANALYZER;
+  if (strcmp(name, "record-telemetry") == 0) return TOPIC_RECORD_TELEMETRY;
+  if (strcmp(name, "record-result") == 0) return TOPIC_RECORD_RESULT;
+  if (strcmp(name, "play-status") == 0) return TOPIC_PLAY_STATUS;
+  if (strcmp(name, "settings") == 0) return TOPIC_SETTINGS;
+  if (strcmp(name, "metrics") == 0) return TOPIC_METRICS;
+  return 0;
+}
+
+// Serializes the reply into the arena (or replyString if it doesn't fit) and hands it to send(data, length)
+template <typename Send>
+static void serializeReply(JsonDocument &reply, Send send) {
+  const size_t length = measureJson(reply);
+  char* buffer = (char*)arena.allocate(length + 1);
+
+  if (buffer == nullptr) {
+    replyString.clear();
+    serializeJson(reply, replyString);
+    send(replyString.c_str(), replyString.length());
+    return;
+  }
+
+  serializeJson(reply, buffer, length + 1);
+  send(buffer, length);
+  arena.deallocate(buffer); // still the most recent block
+}
+
+// Broadcasts to every client subscribed to the topic (results the device produces on its own)
+static void sendReply(JsonDocument &reply, Topic topic) {
+  serializeReply(reply, [topic](const char* data, size_t length) { sendData(data, length, topic); });
+}
+
+// Answers only the client that sent the command
+static void sendReply(JsonDocument &reply, uint32_t client) {
+  serializeReply(reply, [client](const char* data, size_t length) { sendDataTo(data, length, client); });
+}
+
+// ---- Routes ---- //
+
+static void onSubscribe(JsonObject data, uint32_t client) {
+  uint8_t topics = 0;
+  for (JsonVariant name : data["topics"].as<JsonArray>()) {
+    topics |= topicFromName(name.as<const char*>());
+  }
+
+  subscribeClient(client, topics);
+}
+
+static void onAnalyzer(JsonObject data, uint32_t client) {
+  if (data["rssi"].is<int>()) {
+    settings.detect_rssi = data["rssi"].as<int>();
+    Serial.println(F("Updated detect_rssi to "));
+    Serial.print(String(settings.detect_rssi));
+  }
+
+  if (data["active"].is<bool>()) {
+    if (data["active"] == true) {
+      status.detect = "QUEUED";
+    } else if (data["active"] == false) {
+      status.detect = "IDLE";
+    }
+  }
+}
+
+static void onSniff(JsonObject data, uint32_t client) {
+  if (data["active"].is<bool>()) {
+    if (data["active"] == true) {
+      if (data["interval"].is<int>()) sniffInterval = data["interval"].as<int>();
+      if (data["rx_time"].is<int>()) sniffRxTime = data["rx_time"].as<int>();
+      if (status.sniff == "IDLE") status.sniff = "QUEUED"; // started by the main loop
+    } else {
+      status.sniff = "IDLE";
+    }
+  }
+}
+
+static void onRecord(JsonObject data, uint32_t client) {
+  if (data["active"].is<bool>()) {
+    // Sniff mode owns the recording radio and finishes its own captures on the main task, a stop ends sniff mode there
+    if (status.sniff != "IDLE") {
+      if (data["active"] == true) {
+        Serial.println(F("Recording can't be started while sniff mode is running."));
+      } else {
+        status.sniff = "IDLE";
+      }
+      return;
+    }
+
+    if (data["active"] == true) {
+      Serial.println(F("Recording has been successfully started with user settings."));
+      startRecording();
+    } else {
+      finishRecording();
+    }
+  }
+}
+
+// A /play request is parsed under the arena lock, but transmitting takes as long as the signal itself, so it's only
+// queued here and dispatchCommand() plays it once the lock is released (other commands and replies don't wait for it)
+struct PendingPlay {
+  int length; // samples in tempSmooth, 0 if nothing is queued
+  int repeat;
+  int frequency;
+  char preset[16];
+};
+
+static PendingPlay pendingPlay = {};
+static std::atomic<bool> playBusy(false); // tempSmooth holds the samples from the request until they have been played
+
+static void onPlay(JsonObject data, uint32_t client) {
+  if (!(data["samples"].is<const char*>() && data["frequency"].is<int>() && data["length"].is<int>() && data["preset"].is<const char*>())) return;
+
+  JsonDocument confirmDoc(&arena);
+  confirmDoc["url"] = "/play";
+
+  if (playBusy.exchange(true)) {
+    Serial.println(F("A file is already being played, the new request has been refused."));
+    confirmDoc["data"]["success"] = false;
+    sendReply(confirmDoc, client);
+    return;
+  }
+
+  flushSamples(); // free up memory
+
+  // The samples are parsed straight into the (now unused) smoothing buffer instead of another document
+  const int reqLength = parseSampleList(data["samples"].as<const char*>(), tempSmooth, min(data["length"].as<int>(), MAX_SAMPLES));
+
+  const int repeat = data["repeat"].is<int>() ? data["repeat"].as<int>() : 1; // trimmed recordings are looped
+  const bool allowed = playWithinLimits(tempSmooth, reqLength, repeat);
+  if (!allowed) Serial.println(F("The requested file repeats or plays for too long, it has been refused."));
+
+  if (reqLength > 0 && allowed) {
+    pendingPlay.length = reqLength;
+    pendingPlay.repeat = repeat;
+    pendingPlay.frequency = data["frequency"].as<int>();
+    snprintf(pendingPlay.preset, sizeof(pendingPlay.preset), "%s", data["preset"].as<const char*>());
+  } else {
+    playBusy = false;
+  }
+
+  confirmDoc["data"]["success"] = reqLength > 0 && allowed;
+  sendReply(confirmDoc, client);
+}
+
+// Plays a queued request w/ the file's settings and reverts to the user's afterwards (called w/o the arena lock)
+static void playQueued(const PendingPlay &play) {
+  // Store old settings to revert when done (static so their buffers are reused)
+  static String old_preset;
+  old_preset = settings.preset;
+  int old_freq = settings.frequency;
+
+  // Update settings to new data
+  settings.preset = play.preset;
+  settings.frequency = play.frequency;
+  Serial.println(F("Now playing file requested by user, successfully updated to file settings."));
+
+  playSignal(tempSmooth, play.length, max(play.repeat, 1));
+
+  Serial.println(F("Successfully played file requested, reverting back to old settings."));
+  // Revert settings back to original
+  settings.preset = old_preset;
+  settings.frequency = old_freq;
+  playBusy = false;
+}
+
+static void onMetrics(JsonObject data, uint32_t client) {
+  JsonDocument confirmDoc(&arena);
+  confirmDoc["url"] = "/metrics";
+  metricsToJson(confirmDoc["data"].to<JsonObject>());
+  sendReply(confirmDoc, client);
+}
+
+static void onSettings(JsonObject data, uint32_t client) {
+  JsonDocument confirmDoc(&arena);
+  confirmDoc["url"] = "/settings";
+
+  const bool update = data["update"] == true;
+  if (update) {
+    if (data["preset"].is<const char*>()) {
+      settings.preset = data["preset"].as<const char*>();
+    }
+
+    if (data["frequency"].is<int>()) {
+      settings.frequency = data["frequency"].as<int>();
+    }
+
+    if (data["rssi"].is<int>()) {
+      settings.rssi = data["rssi"].as<int>();
+    }
+
+    saveSettings(); // Save settings in non-volatile storage
+    confirmDoc["data"]["success"] = true;
+  } else {
+    settingsToJson(confirmDoc["data"]["settings"].to<JsonObject>());
+    settingsOptionsToJson(confirmDoc["data"]["options"].to<JsonObject>());
+    statusToJson(confirmDoc["data"]["status"].to<JsonObject>());
+  }
+
+  confirmDoc["update"] = update;
+  sendReply(confirmDoc, client);
+}
+
+struct Route {
+  const char* url;
+  void (*handler)(JsonObject data, uint32_t client);
+};
+
+static const Route routes[] = {
+  { "/subscribe", onSubscribe },
+  { "/analyzer", onAnalyzer },
+  { "/sniff", onSniff },
+  { "/record", onRecord },
+  { "/play", onPlay },
+  { "/metrics", onMetrics },
+  { "/settings", onSettings },
+};
+
+// Handles one complete message from any transport (client is the websocket client id, 0 over BLE)
+void dispatchCommand(const char* message, size_t length, uint32_t client) {
+  if (length == 0) return;
+  PendingPlay play = {};
+
+  {
+    ArenaScope scope;
+    JsonDocument doc(&arena);
+    DeserializationError error = deserializeJson(doc, message, length);
+    if (error) {
+      metrics.commandErrors++;
+      Serial.printf("[COMMANDS]: could not parse a %u byte message (%s).\n", (unsigned)length, error.c_str());
+      return;
+    }
+
+    const char* url = doc["url"];
+    const Route* route = nullptr;
+    for (const Route &candidate : routes) {
+      if (url != nullptr && strcmp(url, candidate.url) == 0) {
+        route = &candidate;
+        break;
+      }
+    }
+
+    if (route == nullptr) {
+      metrics.commandErrors++;
+      return;
+    }
+
+    route->handler(doc["data"], client);
+
+    play = pendingPlay; // taken while the lock is still held
+    pendingPlay.length = 0;
+  }
+
+  metrics.commands++;
+  metrics.commandHeapLast = ESP.getFreeHeap();
+  if (metrics.commandHeapFirst == 0) metrics.commandHeapFirst = metrics.commandHeapLast;
+
+  if (play.length > 0) playQueued(play);
+}
+
+static void fillRecordResult(JsonDocument &doc, const String &samples, int repeat, uint32_t capture, const FingerprintMatch similar[], int similarCount) {
+  doc["url"] = "/record";
+  doc["data"]["success"] = true;
+  doc["data"]["samples"] = samples;
+  doc["data"]["repeat"] = repeat;
+  doc["data"]["capture"] = capture;
+  doc["data"]["duplicate"] = similarCount > 0 && similar[0].distance <= FINGERPRINT_DUPLICATE_BITS;
+
+  JsonArray similarArray = doc["data"]["similar"].to<JsonArray>();
+  for (int i = 0; i < similarCount; i++) {
+    JsonObject match = similarArray.add<JsonObject>();
+    match["id"] = similar[i].id;
+    match["distance"] = similar[i].distance;
+  }
+}
+
+// Sends a finished recording, built in the arena like the command replies (called from loop() in sniff mode as well)
+void sendRecordResult(const String &samples, int repeat, uint32_t capture, const FingerprintMatch similar[], int similarCount) {
+  ArenaScope scope;
+
+  JsonDocument responseDoc(&arena);
+  fillRecordResult(responseDoc, samples, repeat, capture, similar, similarCount);
+  if (!responseDoc.overflowed()) {
+    sendReply(responseDoc, TOPIC_RECORD_RESULT);
+    return;
+  }
+
+  // Long recordings w/o repeats don't fit, only those go through the heap (counted in arena_overflows)
+  responseDoc.clear();
+  JsonDocument heapDoc;
+  fillRecordResult(heapDoc, samples, repeat, capture, similar, similarCount);
+  sendReply(heapDoc, TOPIC_RECORD_RESULT);
+}
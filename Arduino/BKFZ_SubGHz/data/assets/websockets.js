@@ -1,6 +1,19 @@
+// Topics each page subscribes to (the server only sends messages for subscribed topics)
+const pageTopics = {
+    '/analyzer': ['analyzer'],
+    '/record': ['record-telemetry', 'record-result']
+};
+
 $(document).ready(function () {
     window.ws = new WebSocket(`ws://${window.location.host}/ws`);
 
+    window.ws.onopen = function() {
+        window.ws.send(JSON.stringify({
+            url: '/subscribe',
+            data: { topics: pageTopics[document.location.pathname] || [] }
+        }));
+    };
+
     // Handle websocket message with custom callback
     window.ws.onmessage = function(event) {
         const dataParsed = JSON.parse(event.data);
@@ -0,0 +1,170 @@
+#include "headers/decoder.h"
+#include <stdlib.h>
+#include <math.h>
+
+/* Documentation & References
+# Protocol timings are taken from the Flipper Zero SubGHz protocol decoders (Princeton frames end w/ a 1:31 sync bit).
+  https://github.com/flipperdevices/flipperzero-firmware/tree/dev/lib/subghz/protocols
+*/
+
+const Protocol Protocols[] = {
+  { "Princeton", 350, 3, 24, 24, LAYOUT_SYNC_PULSE },
+  { "CAME", 320, 2, 12, 24, LAYOUT_START_PULSE },
+  { "Nice FLO", 700, 2, 12, 24, LAYOUT_START_PULSE },
+  { "Linear", 500, 3, 10, 10, LAYOUT_TRAILING_HIGH },
+};
+
+const int numProtocols = sizeof(Protocols) / sizeof(Protocols[0]);
+
+// Reads a (short, long) or (long, short) pair as a bit, returns -1 if the pair is neither
+static int pairToBit(bool firstLong, bool secondLong) {
+  if (!firstLong && secondLong) return 0;
+  if (firstLong && !secondLong) return 1;
+  return -1;
+}
+
+// Tries to read the frame as the given protocol, pulses are already split into short (false) and long (true)
+static bool readFrame(const Protocol &protocol, const bool isLong[], int length, uint64_t &key, int &bits) {
+  if (length % 2 == 0) return false;
+  key = 0;
+
+  switch (protocol.layout) {
+    case LAYOUT_SYNC_PULSE:
+      bits = (length - 1) / 2;
+      if (isLong[length - 1]) return false; // sync pulse is always short
+      break;
+    case LAYOUT_TRAILING_HIGH:
+      bits = (length + 1) / 2;
+      break;
+    case LAYOUT_START_PULSE:
+      bits = (length - 1) / 2;
+      if (isLong[0]) return false; // start pulse is always short
+      break;
+    default:
+      return false;
+  }
+
+  if (bits < protocol.minBits || bits > protocol.maxBits) return false;
+
+  for (int i = 0; i < bits; i++) {
+    int bit;
+
+    if (protocol.layout == LAYOUT_START_PULSE) {
+      bit = pairToBit(isLong[1 + i * 2], isLong[2 + i * 2]); // (low, high)
+    } else if (protocol.layout == LAYOUT_TRAILING_HIGH && i == bits - 1) {
+      bit = isLong[i * 2] ? 1 : 0; // the low of the last bit is the gap
+    } else {
+      bit = pairToBit(isLong[i * 2], isLong[i * 2 + 1]); // (high, low)
+    }
+
+    if (bit < 0) return false;
+    key = (key << 1) | bit;
+  }
+
+  return true;
+}
+
+// Splits the frame into a short and long cluster and matches it against every protocol
+static bool decodeFrame(const uint16_t frame[], int length, DecodedSignal &result) {
+  if (length < 3) return false;
+
+  int shortest = frame[0];
+  int longest = frame[0];
+  for (int i = 1; i < length; i++) {
+    if (frame[i] < shortest) shortest = frame[i];
+    if (frame[i] > longest) longest = frame[i];
+  }
+
+  if (longest * 2 < shortest * 3) return false; // only one pulse width, nothing to decode
+
+  // Average both clusters to measure te and the long/short ratio
+  int threshold = (shortest + longest) / 2;
+  long shortSum = 0, longSum = 0;
+  int shortCount = 0, longCount = 0;
+  bool isLong[DECODER_MAX_FRAME];
+
+  for (int i = 0; i < length; i++) {
+    isLong[i] = frame[i] > threshold;
+
+    if (isLong[i]) {
+      longSum += frame[i];
+      longCount++;
+    } else {
+      shortSum += frame[i];
+      shortCount++;
+    }
+  }
+
+  int te = shortSum / shortCount;
+  float ratio = (float)longSum / longCount / te;
+
+  // The protocol w/ the closest te wins if more than one layout fits
+  const Protocol* best = nullptr;
+  int bestError = 0;
+  uint64_t bestKey = 0;
+  int bestBits = 0;
+
+  for (int p = 0; p < numProtocols; p++) {
+    const Protocol &protocol = Protocols[p];
+    int error = abs(te - protocol.te);
+
+    if (error * 10 > protocol.te * 4) continue; // te is off by more than 40%
+    if (fabsf(ratio - protocol.ratio) > 0.6f) continue;
+    if (best != nullptr && error >= bestError) continue;
+
+    uint64_t key;
+    int bits;
+    if (readFrame(protocol, isLong, length, key, bits)) {
+      best = &protocol;
+      bestError = error;
+      bestKey = key;
+      bestBits = bits;
+    }
+  }
+
+  if (best == nullptr) return false;
+
+  result.protocol = best;
+  result.key = bestKey;
+  result.bits = bestBits;
+  result.te = te;
+  return true;
+}
+
+void resetDecoder(Decoder &decoder) {
+  decoder.length = -1;
+  decoder.last = { nullptr, 0, 0, 0 };
+}
+
+// Called for every pulse, frames are only decoded once a gap ends them (so the cost per pulse stays bounded)
+bool feedDecoder(Decoder &decoder, int duration, DecodedSignal &result) {
+  duration = abs(duration);
+
+  if (duration >= DECODER_GAP) {
+    DecodedSignal decoded;
+    bool found = decoder.length > 0 && decodeFrame(decoder.frame, decoder.length, decoded);
+    decoder.length = 0;
+
+    if (!found) return false;
+    if (decoded.protocol == decoder.last.protocol && decoded.key == decoder.last.key && decoded.bits == decoder.last.bits) return false; // repeated frame
+
+    decoder.last = decoded;
+    result = decoded;
+    return true;
+  }
+
+  if (decoder.length < 0) return false; // still waiting for the first gap
+
+  if (decoder.length >= DECODER_MAX_FRAME) {
+    decoder.length = -1; // too long for any protocol, skip until the next gap
+    return false;
+  }
+
+  decoder.frame[decoder.length++] = duration;
+  return false;
+}
+
+// Decodes the pulses collected since the last gap, the last frame of a burst has no gap after it until the next burst
+bool flushDecoder(Decoder &decoder, DecodedSignal &result) {
+  return feedDecoder(decoder, DECODER_GAP, result);
+}
@@ -0,0 +1,79 @@
+#include "headers/fingerprint.h"
+#include "headers/processing.h"
+#include <stdlib.h>
+#include <limits.h>
+
+// Pulse length in multiples of the shortest pulse (gaps all share one class), the level is left out since a dropped
+// noise pulse flips the level of every pulse after it
+static uint8_t pulseClass(int value, int shortest) {
+  const int duration = abs(value);
+  int units = duration >= shortest * REPEAT_GAP ? 0 : (duration + shortest / 2) / shortest;
+  if (units > FINGERPRINT_MAX_UNITS) units = FINGERPRINT_MAX_UNITS;
+
+  return units;
+}
+
+// SimHash over every run of FINGERPRINT_GRAM pulses, so it doesn't matter where in the repeats a capture starts
+// (or how many repeats it has), and smoothened timings that are slightly off still land in the same class
+uint64_t fingerprintSamples(const int samples[], int length) {
+  if (length < FINGERPRINT_GRAM) return 0;
+
+  int shortest = INT_MAX;
+  for (int i = 0; i < length; i++) {
+    if (samples[i] != 0 && abs(samples[i]) < shortest) shortest = abs(samples[i]);
+  }
+
+  int weights[64] = {};
+  for (int i = 0; i + FINGERPRINT_GRAM <= length; i++) {
+    uint64_t hash = 14695981039346656037ull;
+    for (int j = 0; j < FINGERPRINT_GRAM; j++) {
+      hash ^= pulseClass(samples[i + j], shortest);
+      hash *= 1099511628211ull;
+    }
+
+    // FNV-1a alone barely changes the high bits, finish w/ the splitmix64 mixer
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBull;
+    hash ^= hash >> 31;
+
+    for (int b = 0; b < 64; b++) {
+      weights[b] += (hash >> b) & 1 ? 1 : -1;
+    }
+  }
+
+  uint64_t fingerprint = 0;
+  for (int b = 0; b < 64; b++) {
+    if (weights[b] > 0) fingerprint |= 1ull << b;
+  }
+
+  return fingerprint;
+}
+
+int fingerprintDistance(uint64_t a, uint64_t b) {
+  return __builtin_popcountll(a ^ b);
+}
+
+// Captures on the same frequency w/ a similar fingerprint, closest first (returns how many were found)
+int findSimilar(const Fingerprint index[], int count, const Fingerprint &query, FingerprintMatch matches[], int maxMatches) {
+  int found = 0;
+
+  for (int i = 0; i < count; i++) {
+    if (index[i].frequency != query.frequency) continue;
+
+    const int distance = fingerprintDistance(index[i].hash, query.hash);
+    if (distance > FINGERPRINT_MATCH_BITS) continue;
+
+    // Insert sorted, the farthest match falls off once the list is full
+    int at = found < maxMatches ? found++ : maxMatches;
+    while (at > 0 && matches[at - 1].distance > distance) {
+      if (at < maxMatches) matches[at] = matches[at - 1];
+      at--;
+    }
+
+    if (at < maxMatches) matches[at] = { index[i].id, distance };
+  }
+
+  return found;
+}
@@ -0,0 +1,86 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static_assert(ARDUINOJSON_VERSION_MAJOR >= 7, "ArduinoJson 7 or newer is required (custom allocators, JsonDocument)");
+
+// Bump allocator for JsonDocument over a fixed buffer, everything is released at once w/ reset() (nothing touches the heap)
+class ArenaAllocator : public ArduinoJson::Allocator {
+  public:
+    ArenaAllocator(uint8_t* buffer, size_t size) : buffer(buffer), size(size) {}
+
+    void* allocate(size_t bytes) override {
+      const size_t needed = HEADER + align(bytes);
+      if (used + needed > size) {
+        overflows++;
+        return nullptr;
+      }
+
+      uint8_t* block = buffer + used;
+      *(size_t*)block = bytes; // the size is kept in front of the block for reallocate()
+      used += needed;
+      if (used > peak) peak = used;
+
+      last = block + HEADER;
+      return last;
+    }
+
+    // Only the most recent block can be given back, everything else waits for reset()
+    void deallocate(void* ptr) override {
+      if (ptr == nullptr || ptr != last) return;
+
+      used = (uint8_t*)ptr - HEADER - buffer;
+      last = nullptr;
+    }
+
+    // JsonDocument grows its string buffer and pool list w/ this, the most recent block grows in place
+    void* reallocate(void* ptr, size_t bytes) override {
+      if (ptr == nullptr) return allocate(bytes);
+
+      size_t* header = (size_t*)((uint8_t*)ptr - HEADER);
+      if (ptr == last) {
+        const size_t end = (uint8_t*)ptr - buffer + align(bytes);
+        if (end > size) {
+          overflows++;
+          return nullptr;
+        }
+
+        *header = bytes;
+        used = end;
+        if (used > peak) peak = used;
+        return ptr;
+      }
+
+      void* moved = allocate(bytes);
+      if (moved == nullptr) return nullptr;
+
+      memcpy(moved, ptr, *header < bytes ? *header : bytes);
+      return moved;
+    }
+
+    void reset() {
+      used = 0;
+      last = nullptr;
+    }
+
+    size_t capacity() const { return size; }
+
+    size_t peak = 0; // most bytes in use at once since boot
+    uint32_t overflows = 0; // allocations that didn't fit
+
+  private:
+    static constexpr size_t HEADER = 8; // keeps every block 8-byte aligned
+
+    static size_t align(size_t bytes) { return (bytes + 7) & ~(size_t)7; }
+
+    uint8_t* buffer;
+    size_t size;
+    size_t used = 0;
+    void* last = nullptr;
+};
+
+#endif
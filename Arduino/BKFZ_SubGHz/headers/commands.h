@@ -0,0 +1,13 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <Arduino.h>
+#include <headers/fingerprint.h> // FingerprintMatch (capture index)
+
+// Parsing and replies for one inbound message, the largest is a /play request w/ every sample in one JSON string
+constexpr size_t COMMAND_ARENA_SIZE = 48 * 1024;
+
+void dispatchCommand(const char* message, size_t length, uint32_t client);
+void sendRecordResult(const String &samples, int repeat, uint32_t capture, const FingerprintMatch similar[], int similarCount);
+
+#endif
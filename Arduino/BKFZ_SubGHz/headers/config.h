@@ -25,10 +25,38 @@ constexpr int CSN_CPIN  = 5;
 constexpr int GDO0_CPIN = 16;
 constexpr int GDO2_CPIN = 18;
 
+/* CC1101 Modules (SCK/MISO/MOSI are shared, every module needs its own CSN/GDO0/GDO2 pins) */
+struct RadioPins {
+  int csn;
+  int gdo0;
+  int gdo2;
+};
+
+constexpr RadioPins RADIOS[] = {
+  { CSN_CPIN, GDO0_CPIN, GDO2_CPIN }, // records, replays and sniffs
+  // { 17, 21, 22 }, // second module (optional), runs the frequency analyzer so the band can be watched while recording
+};
+
+constexpr int RADIO_COUNT = sizeof(RADIOS) / sizeof(RADIOS[0]);
+constexpr int RADIO_RECORD = 0;
+constexpr int RADIO_ANALYZER = RADIO_COUNT > 1 ? 1 : 0; // shares the recording radio if there's only one
+static_assert(RADIO_COUNT <= 6, "The CC1101 driver supports up to 6 modules");
+
 /* Recording Parameters */
 constexpr int MAX_SAMPLES = 8000;
 constexpr int ERROR_TOLERANCE = 200;
 
+/* Playback Limits (requests above them are refused) */
+constexpr int PLAY_MAX_REPEAT = 128; // the most repeats a trimmed recording reports (REPEAT_MAX_SEGMENTS)
+constexpr unsigned long PLAY_MAX_MS = 20000; // longest transmission a request may ask for (all repeats together)
+
+/* Sniff Mode (CC1101 Wake-on-Radio) */
+constexpr int SNIFF_INTERVAL_MS = 250; // how often the CC1101 listens (default, can be sent w/ the sniff request)
+constexpr int SNIFF_RX_TIME = 3; // RX window, 0 = 12.5% of the interval and each step halves it (0-6)
+constexpr int SNIFF_QUIET_MS = 300; // a capture ends once no edge was accepted for this long
+constexpr int SNIFF_MIN_EDGES = 24; // captures w/ fewer edges are false wakes and dropped (a 12 bit frame has 24)
+constexpr bool SNIFF_LIGHT_SLEEP = false; // light-sleep the ESP32 between wake-ups (Wi-Fi/BLE clients will disconnect)
+
 // Choose a connection mode ("WIFI" or "BLE")
 #define CONNECTION_MODE CONNECTION_MODE_WIFI
 
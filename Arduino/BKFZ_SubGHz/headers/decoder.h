@@ -0,0 +1,50 @@
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdint.h>
+
+/* Decoder Parameters */
+constexpr int DECODER_GAP = 5000; // any pulse longer than this (in us) separates two frames
+constexpr int DECODER_MAX_BITS = 64; // longest key we try to decode
+constexpr int DECODER_MAX_FRAME = DECODER_MAX_BITS * 2 + 2; // pulses kept between two gaps
+
+// How the bits of a protocol are laid out between two gaps
+enum FrameLayout : uint8_t {
+  LAYOUT_SYNC_PULSE, // (high, low) pairs followed by a short high before the gap (Princeton/PT2262, EV1527)
+  LAYOUT_TRAILING_HIGH, // (high, low) pairs where the low of the last bit is the gap itself (Linear)
+  LAYOUT_START_PULSE, // short start pulse followed by (low, high) pairs (CAME, Nice FLO)
+};
+
+// Fixed-code OOK protocol, a short pulse is 1 te and a long pulse is ratio * te
+struct Protocol {
+  const char* name;
+  uint16_t te; // nominal short pulse width (in us)
+  uint8_t ratio; // long pulse / short pulse
+  uint8_t minBits;
+  uint8_t maxBits;
+  FrameLayout layout;
+};
+
+extern const Protocol Protocols[];
+extern const int numProtocols;
+
+// Decoded key w/ the timing it was received with
+struct DecodedSignal {
+  const Protocol* protocol;
+  uint64_t key;
+  uint8_t bits;
+  uint16_t te; // measured short pulse width (in us)
+};
+
+// Decoder state, fed one pulse duration at a time (the first pulse after a gap is always treated as high)
+struct Decoder {
+  uint16_t frame[DECODER_MAX_FRAME];
+  int length; // pulses collected since the last gap, -1 while waiting for the first gap
+  DecodedSignal last; // last decoded signal (repeated frames are only reported once)
+};
+
+void resetDecoder(Decoder &decoder);
+bool feedDecoder(Decoder &decoder, int duration, DecodedSignal &result);
+bool flushDecoder(Decoder &decoder, DecodedSignal &result);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <stdint.h>
+
+/* Fingerprint Parameters */
+constexpr int FINGERPRINT_GRAM = 16; // pulses hashed together (long enough that keys of the same protocol differ)
+constexpr int FINGERPRINT_MAX_UNITS = 15; // pulses longer than this many short pulses (but shorter than a gap) are clamped
+constexpr int FINGERPRINT_MATCH_BITS = 10; // fingerprints w/ at most this many different bits are similar
+constexpr int FINGERPRINT_DUPLICATE_BITS = 6; // ... and w/ at most this many they're reported as a duplicate
+constexpr int FINGERPRINT_MAX_ENTRIES = 512; // oldest captures are overwritten once the index is full
+constexpr const char* FINGERPRINT_INDEX_PATH = "/captures.idx"; // on LittleFS
+
+// One capture in the index (16 bytes, stored as-is on flash)
+struct Fingerprint {
+  uint64_t hash; // SimHash of the pulse sequence
+  uint32_t frequency;
+  uint32_t id; // capture number, the slot on flash is id % FINGERPRINT_MAX_ENTRIES
+};
+
+struct FingerprintMatch {
+  uint32_t id;
+  int distance; // bits that differ
+};
+
+uint64_t fingerprintSamples(const int samples[], int length);
+int fingerprintDistance(uint64_t a, uint64_t b);
+int findSimilar(const Fingerprint index[], int count, const Fingerprint &query, FingerprintMatch matches[], int maxMatches);
+
+#endif
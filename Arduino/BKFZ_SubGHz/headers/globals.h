@@ -16,4 +16,8 @@ extern volatile int graphSkipped;
 extern volatile int graphIndex;
 extern volatile int lastSend;
 
+// ---- Sniff Mode ---- //
+extern int sniffInterval;
+extern int sniffRxTime;
+
 #endif
\ No newline at end of file
@@ -5,18 +5,40 @@
 #include <functional>
 #include <vector>
 
+#include <headers/fingerprint.h> // FingerprintMatch (capture index)
+
+// Topics a client can subscribe to, messages are only sent to clients subscribed to their topic
+enum Topic : uint8_t {
+  TOPIC_ANALYZER = 1 << 0, // frequency analyzer hits
+  TOPIC_RECORD_TELEMETRY = 1 << 1, // graph/sample count updates while recording
+  TOPIC_RECORD_RESULT = 1 << 2, // finished .sub file once recording stops
+  TOPIC_PLAY_STATUS = 1 << 3, // confirmation that a play request was queued (kept for old clients, replies go to the sender)
+  TOPIC_SETTINGS = 1 << 4, // settings/status replies (kept for old clients, replies go to the sender)
+  TOPIC_METRICS = 1 << 5, // metrics replies (kept for old clients, replies go to the sender)
+};
+
 void registerPlayRequest(std::function<void(std::function<void(bool)>)> handler);
 void registerPlay(std::function<void(const std::vector<int>&, int, const String&, const String&)> handler);
 void registerAnalyzer(std::function<void()> handler);
 void registerSettings(std::function<void(const String&, int, int)> handler);
-void sendData(const String &data);
+void sendData(const char* data, size_t length, Topic topic);
+void sendData(const String &data, Topic topic);
+void sendDataTo(const char* data, size_t length, uint32_t client); // replies to the client that sent a command
+void subscribeClient(uint32_t client, uint8_t topics);
 void setupDevice();
 
 /* shared from main ino to interfaces */
+uint32_t logBootStage(const char* stage);
+bool ensureFilesystem(uint32_t waitMs); // true once LittleFS is mounted
+const uint32_t FILESYSTEM_WAIT_FOREVER = UINT32_MAX;
 void flushSamples();
 void stopRecording();
 void startRecording();
+void finishRecording();
 void smoothenSamples();
-void playSignal(const int *samples, int length);
+int trimRepeats();
+int indexCapture(FingerprintMatch matches[], int maxMatches, uint32_t &id);
+String samplesToSub(int repeat);
+void playSignal(const int *samples, int length, int repeat = 1);
 
 #endif
\ No newline at end of file
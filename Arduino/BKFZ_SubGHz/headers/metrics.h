@@ -0,0 +1,66 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+constexpr int HISTOGRAM_BUCKETS = 20; // bucket i counts values below 2^i (the last bucket counts everything above)
+
+// Power-of-two histogram, recording a value is a handful of instructions
+struct Histogram {
+  uint32_t buckets[HISTOGRAM_BUCKETS];
+  uint32_t count;
+  uint32_t max;
+  uint64_t sum;
+};
+
+// Counters are only updated in place, everything else is computed once /api/metrics (or /metrics on BLE) is polled
+struct Metrics {
+  /* Capture */
+  volatile uint32_t edges; // edges stored by onSignalChange()
+  volatile uint32_t droppedEdges; // edges lost because the sample buffer was full
+  volatile uint32_t rssiRejects; // edges ignored because they were below the RSSI threshold
+
+  /* Radio */
+  uint32_t analyzerSweeps; // full passes over the hopper frequencies
+  Histogram hopSettle; // time to retune the CC1101 for each hop (in us)
+  uint32_t sniffWakes; // carrier sense wake-ups in sniff mode
+  uint32_t sniffFalseWakes; // wake-ups that ended w/o enough edges for a recording
+  Histogram wakeToCapture; // time from carrier sense until the capture interrupt is attached (in us)
+
+  /* Processing */
+  Histogram smoothing; // smoothenSamples() duration (in us)
+  Histogram exporting; // samplesToSub() duration (in us)
+  Histogram replayError; // difference between the requested and actual replay length (in us)
+
+  /* Capture Index */
+  uint32_t indexEntries; // fingerprints stored on flash
+  uint32_t indexWriteErrors; // fingerprints that couldn't be written to flash (only kept until reboot)
+  Histogram indexQuery; // time to search the index for similar captures (in us)
+
+  /* Transport */
+  uint32_t bytesSent; // bytes queued to websocket clients or notified over BLE
+  uint32_t messagesSent;
+  uint32_t queueDepthMax; // deepest websocket client queue seen when sending
+
+  /* Commands (dispatchCommand(), same for Wi-Fi and BLE) */
+  uint32_t commands; // messages handled
+  uint32_t commandErrors; // messages that couldn't be parsed or had an unknown url
+  uint32_t commandArenaPeak; // most arena bytes used by one message (or recording result)
+  uint32_t commandArenaOverflows; // allocations that didn't fit in the arena (those replies were built on the heap)
+  uint32_t commandHeapFirst; // free heap after the first message...
+  uint32_t commandHeapLast; // ... and after the latest one (should stay the same)
+
+  /* Boot (in ms since power on, 0 until reached) */
+  uint32_t radioReadyMs;
+  uint32_t networkReadyMs;
+  uint32_t firstResponseMs; // first page served over Wi-Fi
+};
+
+extern Metrics metrics;
+
+void recordHistogram(Histogram &histogram, uint32_t value);
+void metricsToJson(JsonObject doc);
+String metricsToJson();
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef PROCESSING_H
+#define PROCESSING_H
+
+#include <Arduino.h>
+
+/* Repeat Detection Parameters */
+constexpr int REPEAT_GAP = 8; // pulses at least this many times the shortest pulse separate two segments
+constexpr int REPEAT_MAX_SEGMENTS = 128; // segments compared when looking for the repeating period
+
+int smoothenBuffer(int samples[], int tempSmooth[], int sampleIndex);
+String presetToFlipper(String preset);
+String presetFromFlipper(String preset);
+String buildSubFile(const int samples[], int length, const String &preset, int frequency, int repeat, bool trimmed);
+int findRepeatedFrame(const int data[], int length, int &start, int &frameLength);
+int parseSampleList(const char* text, int out[], int maxLength);
+bool playWithinLimits(const int samples[], int length, int repeat);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef RADIO_H
+#define RADIO_H
+
+#include <stdint.h>
+
+constexpr int RADIO_MAX = 6; // modules the CC1101 driver can address
+
+// SPI bus usage of one radio (wait = time until the bus was free, hold = time the bus was used)
+struct RadioStats {
+  uint32_t transactions; // times the radio took the bus
+  uint32_t contended; // transactions that had to wait for another radio
+  uint32_t rssiStale; // RSSI reads from the interrupt skipped because the bus was busy
+  uint32_t waitMaxUs;
+  uint32_t holdMaxUs;
+  uint64_t waitUs;
+  uint64_t holdUs;
+};
+
+extern RadioStats radioStats[RADIO_MAX];
+
+void setupRadios();
+void lockRadio(int radio);
+void unlockRadio(int radio);
+bool tryLockRadioFromISR(int radio);
+void unlockRadioFromISR(int radio);
+
+// Holds the SPI bus for one radio until the end of the scope
+class RadioLock {
+  public:
+    explicit RadioLock(int radio) : radio(radio) { lockRadio(radio); }
+    ~RadioLock() { unlockRadio(radio); }
+
+    RadioLock(const RadioLock&) = delete;
+    RadioLock &operator=(const RadioLock&) = delete;
+
+  private:
+    int radio;
+};
+
+#endif
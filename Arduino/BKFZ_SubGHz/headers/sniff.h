@@ -0,0 +1,33 @@
+#ifndef SNIFF_H
+#define SNIFF_H
+
+#include <stdint.h>
+
+/* Current Draw (typical values from the CC1101 and ESP32 datasheets, in mA) */
+constexpr float CC1101_RX_MA = 15.5; // RX at 433 MHz
+constexpr float CC1101_WAKEUP_MA = 8.0; // crystal start-up and synthesizer calibration
+constexpr float CC1101_WOR_SLEEP_MA = 0.0009; // sleep w/ the WOR RC oscillator running
+constexpr float ESP32_LIGHT_SLEEP_MA = 0.8;
+constexpr float ESP32_AWAKE_MA = 40.0; // idle CPU, radio (Wi-Fi/BLE) not counted
+
+/* CC1101 Wake-on-Radio Timings (in us) */
+constexpr float WOR_EVENT0_US = 750.0 / 26.0; // one EVENT0 tick w/ a 26 MHz crystal and WOR_RES = 0
+constexpr float CC1101_WAKEUP_US = 900; // sleep -> RX, including the calibration set by MCSM0
+constexpr float CARRIER_SENSE_US = 250; // RSSI needs a few samples before carrier sense asserts
+
+// Wake-on-Radio schedule, the CC1101 wakes every interval and listens for a fraction of it
+struct SniffSchedule {
+  uint16_t event0; // WOREVT1:WOREVT0
+  uint8_t rxTime; // MCSM2 RX_TIME, each step halves the RX window (12.5% of the interval at 0)
+  float intervalMs;
+  float rxMs;
+  float dutyCycle; // fraction of time the CC1101 is awake (RX + wake-up)
+};
+
+SniffSchedule sniffSchedule(int intervalMs, int rxTime);
+float sniffCurrent(const SniffSchedule &schedule, bool lightSleep);
+bool sniffWake(const SniffSchedule &schedule, long burstStartUs, long burstLengthUs, long &latencyUs);
+void startSniff(const SniffSchedule &schedule);
+void stopSniff();
+
+#endif
@@ -32,6 +32,7 @@ struct SettingsOptions {
 struct Status {
     String detect;
     String record;
+    String sniff;
 };
 
 extern Settings settings;
@@ -39,9 +40,13 @@ extern SettingsOptions settingsOptions;
 extern Status status;
 extern Preferences preferences;
 
+void settingsToJson(JsonObject doc);
+void settingsOptionsToJson(JsonObject doc);
+void statusToJson(JsonObject doc);
 String settingsToJson();
 String settingsOptionsToJson();
 String statusToJson();
+const String& settingsScript();
 void saveSettings();
 void loadSettings();
 
@@ -0,0 +1,143 @@
+#include "headers/metrics.h"
+#include "headers/radio.h"
+#include "headers/config.h"
+#include "headers/fingerprint.h"
+#include "headers/commands.h"
+#include <ArduinoJson.h>
+
+Metrics metrics = {};
+
+void recordHistogram(Histogram &histogram, uint32_t value) {
+  int bucket = value == 0 ? 0 : 32 - __builtin_clz(value);
+  if (bucket >= HISTOGRAM_BUCKETS) bucket = HISTOGRAM_BUCKETS - 1;
+
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.sum += value;
+  if (value > histogram.max) histogram.max = value;
+}
+
+static void histogramToJson(JsonObject object, const Histogram &histogram) {
+  object["count"] = histogram.count;
+  object["avg"] = histogram.count > 0 ? (uint32_t)(histogram.sum / histogram.count) : 0;
+  object["max"] = histogram.max;
+
+  // Buckets are sent as [upper bound, count] pairs, empty ones are skipped
+  JsonArray buckets = object["buckets"].to<JsonArray>();
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    if (histogram.buckets[i] == 0) continue;
+
+    JsonArray bucket = buckets.add<JsonArray>();
+    bucket.add(i == HISTOGRAM_BUCKETS - 1 ? 0 : (1UL << i)); // 0 means unbounded
+    bucket.add(histogram.buckets[i]);
+  }
+}
+
+// Free stack of a task in bytes (-1 if the task doesn't exist in this connection mode)
+static int stackHighWater(const char* name) {
+  TaskHandle_t task = xTaskGetHandle(name);
+  if (task == NULL) return -1;
+
+  return uxTaskGetStackHighWaterMark(task) * sizeof(StackType_t);
+}
+
+// Writes the metrics into doc, rates are averaged since the previous poll
+void metricsToJson(JsonObject doc) {
+  static unsigned long lastPoll = 0;
+  static uint32_t lastEdges = 0;
+  static uint32_t lastSweeps = 0;
+  static uint32_t lastBytes = 0;
+  static uint32_t lastTransactions[RADIO_MAX] = {};
+
+  const unsigned long now = millis();
+  const float seconds = lastPoll == 0 ? 0 : (now - lastPoll) / 1000.0;
+  const uint32_t edges = metrics.edges;
+
+  JsonObject capture = doc["capture"].to<JsonObject>();
+  capture["edges"] = edges;
+  capture["edges_per_sec"] = seconds > 0 ? (edges - lastEdges) / seconds : 0;
+  capture["dropped"] = metrics.droppedEdges;
+  capture["rssi_rejects"] = metrics.rssiRejects;
+
+  JsonObject radio = doc["radio"].to<JsonObject>();
+  radio["sweeps"] = metrics.analyzerSweeps;
+  radio["sweeps_per_sec"] = seconds > 0 ? (metrics.analyzerSweeps - lastSweeps) / seconds : 0;
+  histogramToJson(radio["hop_settle_us"].to<JsonObject>(), metrics.hopSettle);
+  radio["sniff_wakes"] = metrics.sniffWakes;
+  radio["sniff_false_wakes"] = metrics.sniffFalseWakes;
+  histogramToJson(radio["wake_to_capture_us"].to<JsonObject>(), metrics.wakeToCapture);
+
+  // SPI bus usage per module (in the order of RADIOS), contention only happens w/ more than one module
+  JsonArray modules = radio["modules"].to<JsonArray>();
+  for (int i = 0; i < RADIO_COUNT; i++) {
+    const RadioStats &stats = radioStats[i];
+    JsonObject module = modules.add<JsonObject>();
+
+    module["transactions"] = stats.transactions;
+    module["transactions_per_sec"] = seconds > 0 ? (stats.transactions - lastTransactions[i]) / seconds : 0;
+    module["contended"] = stats.contended;
+    module["rssi_stale"] = stats.rssiStale;
+    module["wait_avg_us"] = stats.transactions > 0 ? (uint32_t)(stats.waitUs / stats.transactions) : 0;
+    module["wait_max_us"] = stats.waitMaxUs;
+    module["hold_avg_us"] = stats.transactions > 0 ? (uint32_t)(stats.holdUs / stats.transactions) : 0;
+    module["hold_max_us"] = stats.holdMaxUs;
+    lastTransactions[i] = stats.transactions;
+  }
+
+  JsonObject processing = doc["processing"].to<JsonObject>();
+  histogramToJson(processing["smoothing_us"].to<JsonObject>(), metrics.smoothing);
+  histogramToJson(processing["export_us"].to<JsonObject>(), metrics.exporting);
+  histogramToJson(processing["replay_error_us"].to<JsonObject>(), metrics.replayError);
+
+  JsonObject index = doc["index"].to<JsonObject>();
+  index["entries"] = metrics.indexEntries;
+  index["bytes"] = metrics.indexEntries * sizeof(Fingerprint);
+  index["write_errors"] = metrics.indexWriteErrors;
+  histogramToJson(index["query_us"].to<JsonObject>(), metrics.indexQuery);
+
+  JsonObject transport = doc["transport"].to<JsonObject>();
+  transport["bytes"] = metrics.bytesSent;
+  transport["bytes_per_sec"] = seconds > 0 ? (metrics.bytesSent - lastBytes) / seconds : 0;
+  transport["messages"] = metrics.messagesSent;
+  transport["queue_depth_max"] = metrics.queueDepthMax;
+
+  JsonObject commands = doc["commands"].to<JsonObject>();
+  commands["count"] = metrics.commands;
+  commands["errors"] = metrics.commandErrors;
+  commands["arena_bytes"] = COMMAND_ARENA_SIZE;
+  commands["arena_peak"] = metrics.commandArenaPeak;
+  commands["arena_overflows"] = metrics.commandArenaOverflows;
+  commands["heap_free_first"] = metrics.commandHeapFirst;
+  commands["heap_free_last"] = metrics.commandHeapLast;
+
+  JsonObject boot = doc["boot"].to<JsonObject>();
+  boot["radio_ready_ms"] = metrics.radioReadyMs;
+  boot["network_ready_ms"] = metrics.networkReadyMs;
+  boot["first_response_ms"] = metrics.firstResponseMs;
+
+  JsonObject memory = doc["memory"].to<JsonObject>();
+  memory["heap_free"] = ESP.getFreeHeap();
+  memory["heap_min_free"] = ESP.getMinFreeHeap();
+  memory["heap_max_block"] = ESP.getMaxAllocHeap();
+
+  JsonObject stack = memory["stack_free"].to<JsonObject>();
+  for (const char* task : { "loopTask", "analyzer", "network", "async_tcp", "btController" }) {
+    int free = stackHighWater(task);
+    if (free >= 0) stack[task] = free;
+  }
+
+  lastPoll = now;
+  lastEdges = edges;
+  lastSweeps = metrics.analyzerSweeps;
+  lastBytes = metrics.bytesSent;
+}
+
+// Converts the metrics as a readable JSON string (served at /api/metrics)
+String metricsToJson() {
+  JsonDocument doc;
+  metricsToJson(doc.to<JsonObject>());
+
+  String jsonString;
+  serializeJson(doc, jsonString);
+  return jsonString;
+}
@@ -0,0 +1,286 @@
+#include "headers/processing.h"
+#include <headers/config.h> // used to configure basic variables (such as pinout, max samples, etc.)
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+
+// Smoothens out the RAW samples to correct format (not written by me!), returns the smoothened length
+int smoothenBuffer(int samples[], int tempSmooth[], int sampleIndex) {
+  #define signalstorage 10
+  
+  // Initialize variables for signal storage, counts, and sums
+  int signalanz = 0;
+  int timingdelay[signalstorage];
+  long signaltimings[signalstorage * 2];
+  int signaltimingscount[signalstorage];
+  long signaltimingssum[signalstorage];
+
+  // Initialize signal timings with default values
+  for (int i = 0; i < signalstorage; i++) {
+    signaltimings[i * 2] = 100000;  // Minimum timing
+    signaltimings[i * 2 + 1] = 0;   // Maximum timing
+    signaltimingscount[i] = 0;      // Count of timings in this range
+    signaltimingssum[i] = 0;        // Sum of timings in this range
+  }
+
+  // Group signals into timing ranges
+  for (int p = 0; p < signalstorage; p++) {
+    for (int i = 1; i < sampleIndex; i++) {
+      // Find the minimum timing for the group
+      if (p == 0) {
+        if (samples[i] < signaltimings[p * 2]) {
+          signaltimings[p * 2] = samples[i];
+        }
+      } else {
+        if (samples[i] < signaltimings[p * 2] && samples[i] > signaltimings[p * 2 - 1]) {
+          signaltimings[p * 2] = samples[i];
+        }
+      }
+    }
+
+    // Find the maximum timing for the group
+    for (int i = 1; i < sampleIndex; i++) {
+      if (samples[i] < signaltimings[p * 2] + ERROR_TOLERANCE && samples[i] > signaltimings[p * 2 + 1]) {
+        signaltimings[p * 2 + 1] = samples[i];
+      }
+    }
+
+    // Count how many samples fall into this timing range and sum their values
+    for (int i = 1; i < sampleIndex; i++) {
+      if (samples[i] >= signaltimings[p * 2] && samples[i] <= signaltimings[p * 2 + 1]) {
+        signaltimingscount[p]++;
+        signaltimingssum[p] += samples[i];
+      }
+    }
+  }
+
+  // Determine how many signal groups are active
+  signalanz = signalstorage;
+  for (int i = 0; i < signalstorage; i++) {
+    if (signaltimingscount[i] == 0) {
+      signalanz = i;
+      break;
+    }
+  }
+
+  // No timing group was found (empty capture or only out-of-range edges), there's nothing to smooth against
+  if (signalanz == 0) {
+    memset(samples, 0, sampleIndex * sizeof(int));
+    return 0;
+  }
+
+  // Sort signal groups by count (from most frequent to least frequent)
+  for (int s = 1; s < signalanz; s++) {
+    for (int i = 0; i < signalanz - s; i++) {
+      if (signaltimingscount[i] < signaltimingscount[i + 1]) {
+        // Swap the signal group data
+        int temp1 = signaltimings[i * 2];
+        int temp2 = signaltimings[i * 2 + 1];
+        int temp3 = signaltimingssum[i];
+        int temp4 = signaltimingscount[i];
+
+        signaltimings[i * 2] = signaltimings[(i + 1) * 2];
+        signaltimings[i * 2 + 1] = signaltimings[(i + 1) * 2 + 1];
+        signaltimingssum[i] = signaltimingssum[i + 1];
+        signaltimingscount[i] = signaltimingscount[i + 1];
+
+        signaltimings[(i + 1) * 2] = temp1;
+        signaltimings[(i + 1) * 2 + 1] = temp2;
+        signaltimingssum[i + 1] = temp3;
+        signaltimingscount[i + 1] = temp4;
+      }
+    }
+  }
+
+  // Calculate average timing for each group
+  for (int i = 0; i < signalanz; i++) {
+    timingdelay[i] = signaltimingssum[i] / signaltimingscount[i];
+  }
+
+  // Correct raw data based on timing groups and assign high/low values
+  bool lastbin = false;  // Tracks whether the last bin was high (false = low, true = high)
+  int smoothCount = 0;
+
+  for (int i = 1; i < sampleIndex; i++) {
+    float r = (float)samples[i] / timingdelay[0];
+    int calculate = r;
+    r = r - calculate;
+    r *= 10;
+    if (r >= 5) {
+      calculate += 1;
+    }
+
+    if (calculate > 0) {
+      // Toggle the bin state between high and low
+      lastbin = !lastbin;
+
+      // Assign positive for high and negative for low
+      tempSmooth[smoothCount] = (lastbin ? 1 : -1) * (calculate * timingdelay[0]);
+      smoothCount++;
+    }
+  }
+
+  // Output smoothed data
+  memset(samples, 0, sampleIndex * sizeof(int)); // Clear just the captured samples
+  for (int i = 0; i < smoothCount; i++) {
+    samples[i] = tempSmooth[i];
+  }
+
+  return smoothCount;
+}
+
+// Converts a preset to the name used by the Flipper Zero
+String presetToFlipper(String preset) {
+  preset.replace("AM270", "FuriHalSubGhzPresetOok270Async");
+  preset.replace("AM650", "FuriHalSubGhzPresetOok650Async");
+  preset.replace("FM238", "FuriHalSubGhzPreset2FSKDev238Async");
+  preset.replace("FM476", "FuriHalSubGhzPreset2FSKDev476Async");
+  return preset;
+}
+
+// Converts a Flipper Zero preset back to the BKFZ SubGHz name (same mapping as the web interface)
+String presetFromFlipper(String preset) {
+  preset.replace("FuriHalSubGhzPresetOok270Async", "AM270");
+  preset.replace("FuriHalSubGhzPresetOok650Async", "AM650");
+  preset.replace("FuriHalSubGhzPreset2FSKDev238Async", "FM238");
+  preset.replace("FuriHalSubGhzPreset2FSKDev476Async", "FM476");
+  return preset;
+}
+
+// Converts samples into the Flipper Zero SUB file format, a trimmed file holds one frame and its repeat count (read by
+// BKFZ SubGHz only, the Flipper Zero ignores the comment) while a full file writes the frame that many times
+String buildSubFile(const int samples[], int length, const String &preset, int frequency, int repeat, bool trimmed) {
+  String prepend = "";
+  String result = "Filetype: Flipper SubGhz RAW File\nVersion: 1\n# Created with BKFZ SubGHz\n";
+  if (trimmed && repeat > 1) {
+    result += "# Repeat: " + String(repeat) + "\n";
+  }
+  result += "Frequency: " + String(frequency) + "\nPreset: " + presetToFlipper(preset) + "\nProtocol: RAW\nRAW_Data: ";
+
+  const int copies = trimmed ? 1 : max(repeat, 1);
+  const int start = (length > 0 && samples[0] < 0) ? 1 : 0; // files always start w/ a high pulse
+  for (int i = start; i < length * copies; ++i) {
+    String valueToAdd = prepend + String(samples[i % length]);
+    result += valueToAdd;
+    prepend = " ";
+    if ((i - start + 1) % 512 == 0) {
+      result += "\nRAW_Data: ";
+      prepend = "";
+    }
+  }
+
+  return result;
+}
+
+// Reads a JSON array of samples (e.g. "[350,-1050,...]") straight into out, returns how many were read
+int parseSampleList(const char* text, int out[], int maxLength) {
+  int length = 0;
+  if (text == nullptr) return 0;
+
+  while (*text != '\0' && length < maxLength) {
+    if (*text == '-' || (*text >= '0' && *text <= '9')) {
+      char* end;
+      out[length++] = strtol(text, &end, 10);
+      text = end;
+    } else {
+      text++; // brackets, commas and whitespace
+    }
+  }
+
+  return length;
+}
+
+// Checks a play request against PLAY_MAX_REPEAT and PLAY_MAX_MS, so a client can't keep the radio transmitting for minutes
+static_assert(PLAY_MAX_REPEAT >= REPEAT_MAX_SEGMENTS, "Every recording has to stay playable");
+
+bool playWithinLimits(const int samples[], int length, int repeat) {
+  if (repeat > PLAY_MAX_REPEAT) return false;
+
+  uint64_t duration = 0;
+  for (int i = 0; i < length; i++) duration += abs(samples[i]);
+
+  return duration * max(repeat, 1) <= PLAY_MAX_MS * 1000ULL;
+}
+
+// FNV-1a hash of a segment, gaps are hashed by their sign only since their length varies between repeats
+static uint32_t hashSegment(const int data[], int from, int to, int gap) {
+  uint32_t hash = 2166136261u;
+
+  for (int i = from; i < to; i++) {
+    int value = abs(data[i]) >= gap ? (data[i] < 0 ? INT_MIN : INT_MAX) : data[i];
+
+    for (int b = 0; b < 4; b++) {
+      hash ^= (value >> (b * 8)) & 0xFF;
+      hash *= 16777619u;
+    }
+  }
+
+  return hash;
+}
+
+// Finds the frame that is repeated in the smoothened samples, returns how many times it was repeated in a row (1 if none)
+int findRepeatedFrame(const int data[], int length, int &start, int &frameLength) {
+  start = 0;
+  frameLength = length;
+  if (length < 4) return 1;
+
+  int shortest = INT_MAX;
+  for (int i = 0; i < length; i++) {
+    if (data[i] != 0 && abs(data[i]) < shortest) shortest = abs(data[i]);
+  }
+
+  const long gap = (long)shortest * REPEAT_GAP;
+
+  // Split the samples into segments which each end w/ a gap
+  int segmentStart[REPEAT_MAX_SEGMENTS + 1];
+  uint32_t segmentHash[REPEAT_MAX_SEGMENTS];
+  int segments = 0;
+  int from = 0;
+
+  for (int i = 0; i < length && segments < REPEAT_MAX_SEGMENTS; i++) {
+    if (abs(data[i]) >= gap || i == length - 1) {
+      segmentStart[segments] = from;
+      segmentHash[segments] = hashSegment(data, from, i + 1, gap);
+      segments++;
+      from = i + 1;
+    }
+  }
+
+  segmentStart[segments] = from;
+  if (segments < 2) return 1;
+
+  // Smallest period (in segments) where most segments match the one a period later (the first and last are usually cut off)
+  int period = 0;
+  for (int p = 1; p <= segments / 2 && period == 0; p++) {
+    int matches = 0;
+    for (int i = 0; i + p < segments; i++) {
+      if (segmentHash[i] == segmentHash[i + p]) matches++;
+    }
+
+    if (matches >= p && matches * 4 >= (segments - p - 2) * 3) period = p;
+  }
+
+  if (period == 0) return 1;
+
+  // The canonical frame starts at the first segment that repeats
+  int first = 0;
+  while (first + period < segments && segmentHash[first] != segmentHash[first + period]) first++;
+
+  int repeat = 1;
+  for (int next = first + period; next + period <= segments; next += period) {
+    bool same = true;
+    for (int j = 0; j < period && same; j++) {
+      same = segmentHash[first + j] == segmentHash[next + j];
+    }
+
+    if (!same) break;
+    repeat++;
+  }
+
+  if (repeat < 2) return 1;
+
+  start = segmentStart[first];
+  frameLength = segmentStart[first + period] - start;
+  return repeat;
+}
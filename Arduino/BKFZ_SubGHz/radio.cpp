@@ -0,0 +1,68 @@
+#include "headers/radio.h"
+#include "headers/config.h"
+#include <ELECHOUSE_CC1101_SRC_DRV.h>
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+
+RadioStats radioStats[RADIO_MAX] = {};
+
+// Tasks queue up on the mutex (w/ priority inheritance), the flag is what the interrupt checks since it can't wait
+static std::mutex busLock;
+static std::atomic<bool> busBusy(false);
+static unsigned long heldSince = 0;
+
+// Registers every module w/ the driver (the bus pins are shared, only CSN and the GDO pins differ)
+void setupRadios() {
+  for (int radio = 0; radio < RADIO_COUNT; radio++) {
+    ELECHOUSE_cc1101.addSpiPin(SCK_CPIN, MISO_CPIN, MOSI_CPIN, RADIOS[radio].csn, radio);
+    ELECHOUSE_cc1101.addGDO(RADIOS[radio].gdo0, RADIOS[radio].gdo2, radio);
+  }
+}
+
+// Takes the SPI bus and points the driver at the radio, every driver call has to happen while it's held
+void lockRadio(int radio) {
+  RadioStats &stats = radioStats[radio];
+  const unsigned long requested = micros();
+
+  if (!busLock.try_lock()) {
+    stats.contended++;
+    busLock.lock();
+  }
+
+  while (busBusy.exchange(true)) {} // only an interrupt on the other core can hold it (for one register read)
+
+  heldSince = micros();
+  const uint32_t waited = heldSince - requested;
+  stats.transactions++;
+  stats.waitUs += waited;
+  if (waited > stats.waitMaxUs) stats.waitMaxUs = waited;
+
+  ELECHOUSE_cc1101.setModul(radio);
+}
+
+void unlockRadio(int radio) {
+  RadioStats &stats = radioStats[radio];
+  const uint32_t held = micros() - heldSince;
+  stats.holdUs += held;
+  if (held > stats.holdMaxUs) stats.holdMaxUs = held;
+
+  busBusy = false;
+  busLock.unlock();
+}
+
+// Never waits, the interrupt keeps its last value if a task is using the bus
+bool tryLockRadioFromISR(int radio) {
+  if (busBusy.exchange(true)) {
+    radioStats[radio].rssiStale++;
+    return false;
+  }
+
+  ELECHOUSE_cc1101.setModul(radio);
+  return true;
+}
+
+void unlockRadioFromISR(int radio) {
+  (void)radio;
+  busBusy = false;
+}
@@ -0,0 +1,83 @@
+#include "headers/sniff.h"
+#include "headers/radio.h"
+#include "headers/config.h"
+#include <ELECHOUSE_CC1101_SRC_DRV.h>
+
+/* Documentation & References
+# Wake-on-Radio (EVENT0 timing, RX_TIME timeouts and MCSM2) is described in the CC1101 datasheet.
+  https://www.ti.com/lit/ds/symlink/cc1101.pdf
+*/
+
+// Converts the sniff interval into WOR register values (WOR_RES = 0, so intervals up to ~1.89s)
+SniffSchedule sniffSchedule(int intervalMs, int rxTime) {
+  SniffSchedule schedule;
+
+  long event0 = (long)(intervalMs * 1000 / WOR_EVENT0_US);
+  if (event0 < 1) event0 = 1;
+  if (event0 > 0xFFFF) event0 = 0xFFFF;
+  if (rxTime < 0) rxTime = 0;
+  if (rxTime > 6) rxTime = 6;
+
+  schedule.event0 = event0;
+  schedule.rxTime = rxTime;
+  schedule.intervalMs = event0 * WOR_EVENT0_US / 1000;
+  schedule.rxMs = schedule.intervalMs * 0.125 / (1 << rxTime);
+  schedule.dutyCycle = (schedule.rxMs + CC1101_WAKEUP_US / 1000) / schedule.intervalMs;
+  if (schedule.dutyCycle > 1) schedule.dutyCycle = 1;
+  return schedule;
+}
+
+// Average current while sniffing w/o any signal (the RX window is shorter when RX_TIME_RSSI ends it early)
+float sniffCurrent(const SniffSchedule &schedule, bool lightSleep) {
+  const float wakeup = (CC1101_WAKEUP_US / 1000) / schedule.intervalMs;
+  const float rx = schedule.dutyCycle - wakeup;
+  const float radio = rx * CC1101_RX_MA + wakeup * CC1101_WAKEUP_MA + (1 - schedule.dutyCycle) * CC1101_WOR_SLEEP_MA;
+
+  return radio + (lightSleep ? ESP32_LIGHT_SLEEP_MA : ESP32_AWAKE_MA);
+}
+
+// Checks whether a burst is caught by one of the RX windows, and how long after it started carrier sense fired
+bool sniffWake(const SniffSchedule &schedule, long burstStartUs, long burstLengthUs, long &latencyUs) {
+  const long period = schedule.intervalMs * 1000;
+  const long window = schedule.rxMs * 1000;
+  const long burstEnd = burstStartUs + burstLengthUs;
+
+  long k = (burstStartUs - CC1101_WAKEUP_US - window) / period;
+  if (k < 0) k = 0;
+
+  for (;; k++) {
+    const long listenStart = k * period + CC1101_WAKEUP_US;
+    if (listenStart >= burstEnd) return false;
+
+    const long overlapStart = listenStart > burstStartUs ? listenStart : burstStartUs;
+    const long overlapEnd = listenStart + window < burstEnd ? listenStart + window : burstEnd;
+
+    if (overlapEnd - overlapStart >= CARRIER_SENSE_US) {
+      latencyUs = overlapStart + CARRIER_SENSE_US - burstStartUs;
+      return true;
+    }
+  }
+}
+
+// Hands the channel polling over to the CC1101, GDO2 goes high once a carrier is sensed
+void startSniff(const SniffSchedule &schedule) {
+  RadioLock lock(RADIO_RECORD);
+  ELECHOUSE_cc1101.SpiStrobe(CC1101_SIDLE);
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_IOCFG2, 0x0E); // GDO2 as carrier sense
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_MCSM2, 0x10 | schedule.rxTime); // end RX early when there's no carrier
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_WOREVT1, schedule.event0 >> 8);
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_WOREVT0, schedule.event0 & 0xFF);
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_WORCTRL, 0x78); // RC oscillator on, EVENT1 timeout, RC calibration, WOR_RES = 0
+  ELECHOUSE_cc1101.SpiStrobe(CC1101_SWORRST);
+  ELECHOUSE_cc1101.SpiStrobe(CC1101_SWOR);
+}
+
+// Leaves Wake-on-Radio straight into continuous RX (faster than running setupCC1101() again)
+void stopSniff() {
+  RadioLock lock(RADIO_RECORD);
+  ELECHOUSE_cc1101.SpiStrobe(CC1101_SIDLE);
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_IOCFG2, 0x0D); // GDO2 back to async serial data
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_MCSM2, 0x07); // no RX timeout
+  ELECHOUSE_cc1101.SpiWriteReg(CC1101_WORCTRL, 0xFB); // same as the presets (RC oscillator off)
+  ELECHOUSE_cc1101.SpiStrobe(CC1101_SRX);
+}
@@ -23,7 +23,8 @@ Settings settings = {
 // Array which contains the current status of the device
 Status status = {
   "IDLE", // Detect (frequency analyzer)
-  "IDLE" // Recording (record)
+  "IDLE", // Recording (record)
+  "IDLE" // Sniffing (duty-cycled record)
 };
 
 // The available options for each setting (used to display on UI)
@@ -57,56 +58,80 @@ SettingsOptions settingsOptions = {
 };
 
 
-// Converts the user settings as a readable JSON string (courtesy of ChatGPT)
-String settingsToJson() {
-  DynamicJsonDocument doc(256);
-
+// Writes the user settings into doc (courtesy of ChatGPT)
+void settingsToJson(JsonObject doc) {
   doc["preset"] = settings.preset;
   doc["frequency"] = settings.frequency;
   doc["rssi"] = settings.rssi;
   doc["detect_rssi"] = settings.detect_rssi;
-
-  String jsonString;
-  serializeJson(doc, jsonString);
-  return jsonString;
 }
 
-// Converts the settings options as a readable JSON string (courtesy of ChatGPT, mainly used for displaying in /settings)
-String settingsOptionsToJson() {
-  DynamicJsonDocument doc(256);
-
-  JsonArray presets = doc.createNestedArray("preset");
-  for (String preset : settingsOptions.preset) {
+// Writes the settings options into doc (courtesy of ChatGPT, mainly used for displaying in /settings)
+void settingsOptionsToJson(JsonObject doc) {
+  JsonArray presets = doc["preset"].to<JsonArray>();
+  for (const String &preset : settingsOptions.preset) {
     presets.add(preset);
   }
 
-  JsonArray frequencies = doc.createNestedArray("frequency");
+  JsonArray frequencies = doc["frequency"].to<JsonArray>();
   for (int frequency : settingsOptions.frequency) {
     frequencies.add(frequency);
   }
 
-  JsonArray rssiThreshold = doc.createNestedArray("rssi");
+  JsonArray rssiThreshold = doc["rssi"].to<JsonArray>();
   for (int threshold : settingsOptions.rssi) {
     rssiThreshold.add(threshold);
   }
-
-  String jsonString;
-  serializeJson(doc, jsonString);
-  return jsonString;
 }
 
-// Converts the status as a readable value (courtesy of ChatGPT)
-String statusToJson() {
-  DynamicJsonDocument doc(128);
-
+// Writes the status into doc (courtesy of ChatGPT)
+void statusToJson(JsonObject doc) {
   doc["detect"] = status.detect;
   doc["record"] = status.record;
+  doc["sniff"] = status.sniff;
+}
+
+// Converts one of the writers above as a readable JSON string (used for /settings.js)
+static String toJsonString(void (*writer)(JsonObject)) {
+  JsonDocument doc;
+  writer(doc.to<JsonObject>());
 
   String jsonString;
   serializeJson(doc, jsonString);
   return jsonString;
 }
 
+String settingsToJson() { return toJsonString(settingsToJson); }
+String settingsOptionsToJson() { return toJsonString(settingsOptionsToJson); }
+String statusToJson() { return toJsonString(statusToJson); }
+
+// Script which defines window.settings for the web interface, only rebuilt when the settings or status change
+const String& settingsScript() {
+  static String script;
+  static Settings cachedSettings;
+  static Status cachedStatus;
+
+  bool changed = script.isEmpty() ||
+    cachedSettings.preset != settings.preset ||
+    cachedSettings.frequency != settings.frequency ||
+    cachedSettings.rssi != settings.rssi ||
+    cachedSettings.detect_rssi != settings.detect_rssi ||
+    cachedStatus.detect != status.detect ||
+    cachedStatus.record != status.record ||
+    cachedStatus.sniff != status.sniff;
+
+  if (changed) {
+    cachedSettings = settings;
+    cachedStatus = status;
+
+    script = "window.settings = " + settingsToJson() + ";\n";
+    script += "window.settings.options = " + settingsOptionsToJson() + ";\n";
+    script += "window.settings.status = " + statusToJson() + ";\n";
+  }
+
+  return script;
+}
+
 // Loads the saved settings/configurations from non-volatile storage
 void loadSettings() {
   preferences.begin("settings", false);
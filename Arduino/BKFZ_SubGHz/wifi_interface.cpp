@@ -6,40 +6,133 @@
   #include <ESPAsyncWebServer.h>
   #include <AsyncTCP.h>
   #include <LittleFS.h>
-  #include <ArduinoJson.h>
+  #include <map>
+  #include <mutex>
 
   #include <headers/user_settings.h> // default user settings and their options
   #include <headers/globals.h> // global variables used across multiple files
+  #include <headers/metrics.h> // counters and histograms served at /api/metrics
+  #include <headers/commands.h> // websocket messages are handled by the shared dispatcher
+  #include <headers/processing.h> // parseSampleList()
 
   AsyncWebServer server(SERVER_PORT);
   AsyncWebSocket ws("/ws");
 
-  void sendData(const String &data) {
-    if (ws.count() > 0) {
-      ws.textAll(data);
+  // Topics each websocket client is subscribed to (keyed by client id)
+  static std::map<uint32_t, uint8_t> subscriptions;
+  static std::mutex subscriptionsLock; // sendData() runs on the main loop, events run on the async TCP task
+
+  // Replaces the topics of a client (sent w/ /subscribe)
+  void subscribeClient(uint32_t client, uint8_t topics) {
+    std::lock_guard<std::mutex> lock(subscriptionsLock);
+    subscriptions[client] = topics;
+  }
+
+  // The message is copied into one shared buffer which is then queued to every subscribed client
+  void sendData(const char* data, size_t length, Topic topic) {
+    if (ws.count() == 0) return;
+
+    // Only the matching ids are copied under the lock, queueing can wait on the client's own lock
+    uint32_t recipients[DEFAULT_MAX_WS_CLIENTS];
+    int count = 0;
+    {
+      std::lock_guard<std::mutex> lock(subscriptionsLock);
+      for (auto &subscription : subscriptions) {
+        if ((subscription.second & topic) && count < DEFAULT_MAX_WS_CLIENTS) recipients[count++] = subscription.first;
+      }
     }
+
+    AsyncWebSocketSharedBuffer buffer;
+    for (int i = 0; i < count; i++) {
+      AsyncWebSocketClient* client = ws.client(recipients[i]);
+      if (client == nullptr || client->status() != WS_CONNECTED) continue;
+
+      if (!buffer) {
+        buffer = std::make_shared<std::vector<uint8_t>>((const uint8_t*)data, (const uint8_t*)data + length);
+      }
+
+      client->text(buffer);
+      metrics.bytesSent += length;
+      metrics.messagesSent++;
+      if (client->queueLen() > metrics.queueDepthMax) metrics.queueDepthMax = client->queueLen();
+    }
+  }
+
+  void sendData(const String &data, Topic topic) {
+    sendData(data.c_str(), data.length(), topic);
   }
 
-  // Simple function to inject settings w/ options in window (used for web server)
-  String injectSettings() {
-    String setJSON = settingsToJson();
-    String setOptionsJSON = settingsOptionsToJson();
-    String statusJSON = statusToJson();
+  void sendDataTo(const char* data, size_t length, uint32_t id) {
+    AsyncWebSocketClient* client = ws.client(id);
+    if (client == nullptr || client->status() != WS_CONNECTED) return;
+
+    client->text(data, length);
+    metrics.bytesSent += length;
+    metrics.messagesSent++;
+    if (client->queueLen() > metrics.queueDepthMax) metrics.queueDepthMax = client->queueLen();
+  }
+
+  // Pages served by the web interface (ETags are computed once, the files only change when LittleFS is re-uploaded)
+  struct Page {
+    const char* path;
+    String etag;
+  };
+
+  static Page homePage = { "/home.html" };
+  static Page recordPage = { "/record.html" };
+  static Page playPage = { "/play.html" };
+  static Page analyzerPage = { "/frequency_analyzer.html" };
+  static Page settingsPage = { "/settings.html" };
+
+  // How long a request waits for LittleFS to be mounted (well below the async_tcp watchdog)
+  static const uint32_t FILESYSTEM_WAIT_MS = 1000;
+
+  // Streams a page from flash, if only a gzipped copy (e.g. record.html.gz) was uploaded it is sent as-is w/ Content-Encoding
+  void sendPage(AsyncWebServerRequest *request, Page &page) {
+    if (!ensureFilesystem(FILESYSTEM_WAIT_MS)) {
+      request->send(503, "text/plain", "LittleFS is not mounted (yet), please try again.");
+      return;
+    }
+
+    if (metrics.firstResponseMs == 0) {
+      metrics.firstResponseMs = logBootStage("first HTTP response");
+    }
+
+    if (page.etag.isEmpty()) {
+      String path = LittleFS.exists(page.path) ? String(page.path) : String(page.path) + ".gz";
+      File file = LittleFS.open(path, "r");
+
+      page.etag = "\"" + String(file.size(), HEX) + "-" + String((uint32_t)file.getLastWrite(), HEX) + "\"";
+      file.close();
+    }
 
-    String setScript = "<script>window.settings = " + setJSON + "</script>";
-    String setOptionsScript = "<script>window.settings.options = " + setOptionsJSON + "</script>";
-    String statusScript = "<script>window.settings.status = " + statusJSON + "</script>";
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == page.etag) {
+      response = request->beginResponse(304); // a 304 has to repeat the validator (RFC 9110, 15.4.5)
+    } else {
+      response = request->beginResponse(LittleFS, page.path, "text/html");
+    }
 
-    return setScript + setOptionsScript + statusScript;
+    response->addHeader("Cache-Control", "no-cache"); // browsers keep the page but revalidate w/ the ETag
+    response->addHeader("ETag", page.etag);
+    request->send(response);
   }
 
   // Event handler for web sockets (mainly used for Frequency Analyzer as quick data transmission)
   void onWsEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
     switch(type) {
       case WS_EVT_CONNECT:
+        {
+          std::lock_guard<std::mutex> lock(subscriptionsLock);
+          subscriptions[client->id()] = 0; // nothing is sent until the client subscribes
+        }
         break;
 
       case WS_EVT_DISCONNECT:
+        {
+          std::lock_guard<std::mutex> lock(subscriptionsLock);
+          subscriptions.erase(client->id());
+        }
         ws.cleanupClients();
 
         if (status.detect == "RUNNING") {
@@ -47,7 +140,10 @@
           Serial.println(F("A websocket user has been disconnected from Frequency Analyzer."));
         }
 
-        if (status.record == "RUNNING") {
+        if (status.sniff != "IDLE") {
+          status.sniff = "IDLE"; // the sniff loop finishes or drops its capture
+          Serial.println(F("A websocket user has been disconnected from Sniff mode."));
+        } else if (status.record == "RUNNING") {
           stopRecording();
           Serial.println(F("A websocket user has been disconnected from Recording."));
         }
@@ -56,77 +152,16 @@
         Serial.printf("WebSocket error: %s\n", (char*)arg);
         break;
       case WS_EVT_DATA: {
-        if (len > 0) {
-          DynamicJsonDocument doc(MAX_SAMPLES + 1024);
-          deserializeJson(doc, data, len);
-          JsonObject dataObject = doc["data"]; // Extract the data provided
-
-          if (doc["url"] == "/analyzer") {
-            if (dataObject.containsKey("rssi")) {
-              settings.detect_rssi = dataObject["rssi"].as<int>();
-              Serial.println(F("Updated detect_rssi to "));
-              Serial.print(String(settings.detect_rssi));
-            }
-          }
-
-          if (doc["url"] == "/record") {
-            if (dataObject.containsKey("active")) {
-              if (dataObject["active"] == true) {
-                Serial.println(F("Recording has been successfully started with user settings."));
-                startRecording();
-              } else { 
-                stopRecording();
-                Serial.print(F("Found "));
-                Serial.print(String(sampleIndex));
-                Serial.print(F(" RAW samples, smoothing needed."));
-                delay(100);
-                smoothenSamples();
-                Serial.println(F("Recording has been successfully finished and samples have been smoothened."));
-
-                String prepend = "";
-                String presetName = settings.preset;
-                int freq_format = settings.frequency;
-                presetName.replace("AM270", "FuriHalSubGhzPresetOok270Async");
-                presetName.replace("AM650", "FuriHalSubGhzPresetOok650Async");
-                presetName.replace("FM238", "FuriHalSubGhzPreset2FSKDev238Async");
-                presetName.replace("FM476", "FuriHalSubGhzPreset2FSKDev238Async");
-
-                String result = "Filetype: Flipper SubGhz RAW File\nVersion: 1\n# Created with BKFZ SubGHz\nFrequency: " + String(freq_format) + "\nPreset: " + presetName + "\nProtocol: RAW\nRAW_Data: ";
-
-                if (samples[0] < 0) {
-                  for (int i = 0; i < sampleIndex - 1; ++i) {
-                    samples[i] = samples[i + 1];
-                  }
-                  sampleIndex--;
-                }
-
-                for (int i = 0; i < sampleIndex; ++i) {
-                  String valueToAdd = prepend + String(samples[i]);
-                  result += valueToAdd;
-                  prepend = " ";
-                  if ((i + 1) % 512 == 0) {
-                    result += "\nRAW_Data: ";
-                    prepend = "";
-                  }
-                }
-
-                DynamicJsonDocument responseDoc(MAX_SAMPLES + 1024);
-                responseDoc["url"] = "/record";
-                responseDoc["data"]["success"] = true;
-                responseDoc["data"]["samples"] = result;
-
-                String jsonString;
-                serializeJson(responseDoc, jsonString);
-                sendData(jsonString);
-                jsonString.clear(); // clean up json string
-                flushSamples(); // flush the samples array once data was transmitted
-              }
-            }
-          }
+        // Only whole messages in one frame are handled (the clients never fragment their messages)
+        AwsFrameInfo* info = (AwsFrameInfo*)arg;
+        if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+          dispatchCommand((const char*)data, len, client->id());
+        } else {
+          metrics.commandErrors++;
         }
         break;
       }
-      
+
       default:
         break;
     }
@@ -136,55 +171,49 @@
     WiFi.softAP(ssid, password);
     IPAddress IP = WiFi.softAPIP();
 
-    if (!LittleFS.begin(true)) {
-      Serial.println(F("An error has occurred while mounting LittleFS. Please check if LittleFS is properly installed."));
-      return;
-    }
+    // Until LittleFS is mounted /assets is answered w/ a 503 here (the static handler would send a cacheable 404)
+    server.on("/assets", HTTP_GET, [] (AsyncWebServerRequest *request) {
+      request->send(503, "text/plain", "LittleFS is not mounted (yet), please try again.");
+    }).setFilter([] (AsyncWebServerRequest *request) { return !ensureFilesystem(FILESYSTEM_WAIT_MS); });
 
-    server.serveStatic("/assets", LittleFS, "/assets");
+    server.serveStatic("/assets", LittleFS, "/assets")
+      .setCacheControl("max-age=86400"); // fonts, icons and libraries rarely change
 
     server.on("/", HTTP_GET, [] (AsyncWebServerRequest *request) {
-      File file = LittleFS.open("/home.html", "r");
-      String content = file.readString();
-
-      file.close();
-      request->send(200, "text/html", content);
+      sendPage(request, homePage);
     });
 
     server.on("/record", HTTP_GET, [] (AsyncWebServerRequest *request) {
-      File file = LittleFS.open("/record.html", "r");
-      String content = file.readString();
-
-      file.close();
-      request->send(200, "text/html", injectSettings() + content);
+      sendPage(request, recordPage);
     });
 
     server.on("/play", HTTP_GET, [] (AsyncWebServerRequest *request) {
-      File file = LittleFS.open("/play.html", "r");
-      String content = file.readString();
-
-      file.close();
-      request->send(200, "text/html", content);
+      sendPage(request, playPage);
     });
 
     server.on("/analyzer", HTTP_GET, [] (AsyncWebServerRequest *request) {
-      File file = LittleFS.open("/frequency_analyzer.html", "r");
-      String content = file.readString();
-
       if (status.detect == "IDLE") {
         status.detect = "QUEUED";
       }
 
-      file.close();
-      request->send(200, "text/html", injectSettings() + content);
+      sendPage(request, analyzerPage);
     });
 
     server.on("/settings", HTTP_GET, [] (AsyncWebServerRequest *request) {
-      File file = LittleFS.open("/settings.html", "r");
-      String content = file.readString();
+      sendPage(request, settingsPage);
+    });
 
-      file.close();
-      request->send(200, "text/html", injectSettings() + content);
+    // Current settings w/ options and status (loaded by pages before their own scripts)
+    server.on("/settings.js", HTTP_GET, [] (AsyncWebServerRequest *request) {
+      AsyncWebServerResponse *response = request->beginResponse(200, "text/javascript", settingsScript());
+      response->addHeader("Cache-Control", "no-store");
+      request->send(response);
+    });
+
+    server.on("/api/metrics", HTTP_GET, [] (AsyncWebServerRequest *request) {
+      AsyncWebServerResponse *response = request->beginResponse(200, "application/json", metricsToJson());
+      response->addHeader("Cache-Control", "no-store");
+      request->send(response);
     });
 
     server.on("/api/play", HTTP_POST, [](AsyncWebServerRequest *request) {
@@ -199,16 +228,14 @@
       String frequencyParam = request->getParam("frequency", true)->value();
       String lengthParam = request->getParam("length", true)->value();
       String presetParam = request->getParam("preset", true)->value();
-      int reqLength = lengthParam.toInt();
-      std::vector<int> reqSamples(reqLength);
 
-      // Reconstruct samples array from response
-      DynamicJsonDocument doc(MAX_SAMPLES + 1024);
-      deserializeJson(doc, samplesParam);
-      JsonArray array = doc.as<JsonArray>();
+      // Reconstruct samples array from response (into the smoothing buffer, unused while playing)
+      int reqLength = parseSampleList(samplesParam.c_str(), tempSmooth, min((int)lengthParam.toInt(), MAX_SAMPLES));
 
-      for (int i = 0; i < reqLength && i < array.size(); i++) {
-        reqSamples[i] = array[i].as<int>();
+      int repeat = request->hasParam("repeat", true) ? request->getParam("repeat", true)->value().toInt() : 1; // trimmed recordings are looped
+      if (!playWithinLimits(tempSmooth, reqLength, repeat)) {
+        request->send(400, "text/plain", "The recording repeats or plays for too long.");
+        return;
       }
 
       request->send(200, "text/plain", "Recording has been placed in queue.");
@@ -222,7 +249,7 @@
       settings.frequency = frequencyParam.toInt();
       Serial.println(F("Now playing file requested by user, successfully updated to file settings."));
 
-      playSignal(reqSamples.data(), reqLength);
+      playSignal(tempSmooth, reqLength, max(repeat, 1));
 
       Serial.println(F("Successfully played file requested, reverting back to old settings."));
       // Revert settings back to original
@@ -0,0 +1,23 @@
+#include "allocations.h"
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete for the whole benchmark. They live in their own file so the compiler never
+// sees the malloc() behind a new expression next to the free() behind its delete (-Wmismatched-new-delete).
+
+std::atomic<unsigned long> allocations(0);
+
+void* operator new(size_t size) {
+  allocations++;
+  if (void* ptr = malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
@@ -0,0 +1,9 @@
+#ifndef BENCH_ALLOCATIONS_H
+#define BENCH_ALLOCATIONS_H
+
+#include <atomic>
+
+// Heap allocations made through operator new since the benchmark started
+extern std::atomic<unsigned long> allocations;
+
+#endif
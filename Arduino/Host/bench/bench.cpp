@@ -0,0 +1,584 @@
+// Host benchmarks for the signal processing and serialization hot paths of the firmware
+//
+// Usage: bkfz_bench [capture.sub ...]
+// Every capture (plus a synthetic one) is tiled to 1k, 10k, 100k and 1M edges and run through each stage.
+
+#include <Arduino.h>
+#include <ELECHOUSE_CC1101_SRC_DRV.h>
+
+#include <headers/processing.h>
+#include <headers/decoder.h>
+#include <headers/presets.h>
+#include <headers/sniff.h>
+#include <headers/radio.h>
+#include <headers/fingerprint.h>
+#include <headers/config.h>
+
+#include "allocations.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if BENCH_JSON
+  #include <ArduinoJson.h>
+  #include <headers/commands.h>
+  #include <headers/metrics.h>
+  #include "firmware.h"
+#endif
+
+// ---- Harness ---- //
+struct Result {
+  double nsPerCall;
+  double allocsPerCall;
+};
+
+// Runs setup() untimed before every call of fn() until enough time was measured
+template <typename Setup, typename Fn>
+static Result measure(Setup setup, Fn fn) {
+  using clock = std::chrono::steady_clock;
+  const auto budget = std::chrono::milliseconds(200);
+
+  clock::duration timed(0);
+  unsigned long allocated = 0;
+  int calls = 0;
+
+  while (calls < 3 || (timed < budget && calls < 10000)) {
+    setup();
+
+    unsigned long before = allocations;
+    auto start = clock::now();
+    fn();
+    timed += clock::now() - start;
+    allocated += allocations - before;
+    calls++;
+  }
+
+  return { std::chrono::duration<double, std::nano>(timed).count() / calls, (double)allocated / calls };
+}
+
+static void report(const char* stage, const std::string &source, size_t edges, const Result &result) {
+  printf("%-18s %-16s %9zu %10.2f %12.1f %10.1f\n", stage, source.c_str(), edges, result.nsPerCall / edges, result.nsPerCall / 1000, result.allocsPerCall);
+}
+
+// ---- Captures ---- //
+
+// Princeton frames w/ timing jitter, as the ISR stores them (unsigned durations, the first one is the time since boot)
+static std::vector<int> syntheticCapture() {
+  std::mt19937 random(1101);
+  std::uniform_int_distribution<int> jitter(-30, 30);
+  std::vector<int> edges = { 1000000 };
+
+  for (int press = 0; press < 8; press++) {
+    uint32_t key = random() & 0xFFFFFF;
+
+    for (int repeat = 0; repeat < 10; repeat++) {
+      for (int bit = 23; bit >= 0; bit--) {
+        bool one = (key >> bit) & 1;
+        edges.push_back((one ? 1050 : 350) + jitter(random));
+        edges.push_back((one ? 350 : 1050) + jitter(random));
+      }
+
+      edges.push_back(350 + jitter(random));
+      edges.push_back(10850 + jitter(random) * 10);
+    }
+  }
+
+  return edges;
+}
+
+// Reads the RAW_Data of a .sub file as unsigned durations
+static bool loadCapture(const char* path, std::vector<int> &edges) {
+  std::ifstream file(path);
+  if (!file) return false;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.rfind("RAW_Data:", 0) != 0) continue;
+
+    std::istringstream values(line.substr(9));
+    int value;
+    while (values >> value) edges.push_back(abs(value));
+  }
+
+  return !edges.empty();
+}
+
+// Repeats the capture until it has exactly the requested number of edges
+static std::vector<int> tile(const std::vector<int> &capture, size_t edges) {
+  std::vector<int> tiled(edges);
+  for (size_t i = 0; i < edges; i++) tiled[i] = capture[i % capture.size()];
+  return tiled;
+}
+
+// ---- Benchmarks ---- //
+static void benchCapture(const std::string &source, const std::vector<int> &capture) {
+  for (size_t edges : { 1000, 10000, 100000, 1000000 }) {
+    const std::vector<int> raw = tile(capture, edges);
+    std::vector<int> work(edges), scratch(edges);
+
+    report("smoothenBuffer", source, edges, measure(
+      [&] { work = raw; },
+      [&] { smoothenBuffer(work.data(), scratch.data(), edges); }
+    ));
+
+    work = raw;
+    const int length = smoothenBuffer(work.data(), scratch.data(), edges);
+    const std::vector<int> smoothed(work.begin(), work.begin() + length);
+
+    report("findRepeatedFrame", source, edges, measure(
+      [] {},
+      [&] { int start, frameLength; findRepeatedFrame(smoothed.data(), length, start, frameLength); }
+    ));
+
+    Decoder decoder;
+    report("feedDecoder", source, edges, measure(
+      [&] { resetDecoder(decoder); },
+      [&] { DecodedSignal decoded; for (int edge : raw) feedDecoder(decoder, edge, decoded); }
+    ));
+
+    String file;
+    report("buildSubFile", source, edges, measure(
+      [&] { file = String(); },
+      [&] { file = buildSubFile(smoothed.data(), length, "AM650", 433920000, 1, true); }
+    ));
+
+    // The samples string of a /play request, as the dispatcher reads it
+    std::string sampleList = "[";
+    for (int i = 0; i < length; i++) sampleList += (i > 0 ? "," : "") + std::to_string(smoothed[i]);
+    sampleList += "]";
+
+    std::vector<int> parsed(length);
+    report("parseSampleList", source, edges, measure(
+      [] {},
+      [&] { parseSampleList(sampleList.c_str(), parsed.data(), length); }
+    ));
+
+#if BENCH_JSON
+    // A /play request as the app sends it (the samples are one JSON string), through the firmware's dispatcher
+    std::string playMessage;
+    {
+      JsonDocument message;
+      message["url"] = "/play";
+      message["data"]["samples"] = sampleList;
+      message["data"]["frequency"] = 433920000;
+      message["data"]["length"] = length;
+      message["data"]["preset"] = "AM650";
+      serializeJson(message, playMessage);
+    }
+
+    // Skipped once the message doesn't fit in the arena, the device rejects those as well
+    if (playMessage.size() * 2 < COMMAND_ARENA_SIZE) {
+      report("dispatch /play", source, edges, measure(
+        [] {},
+        [&] { dispatchCommand(playMessage.c_str(), playMessage.size(), 1); }
+      ));
+    }
+
+    // The finished recording as finishRecording() sends it (large untrimmed files fall back to the heap)
+    const FingerprintMatch similar[3] = { { 1, 2 }, { 7, 9 }, { 12, 14 } };
+    report("sendRecordResult", source, edges, measure(
+      [] {},
+      [&] { sendRecordResult(file, 1, 42, similar, 3); }
+    ));
+#endif
+  }
+}
+
+static void benchPresets() {
+  static const char* names[] = { "AM270", "AM650", "FM238", "FM476" };
+  int next = 0;
+
+  ELECHOUSE_cc1101.writes = 0;
+  Result result = measure(
+    [] {},
+    [&] {
+      const Preset* preset = findPreset(names[next++ % 4]);
+      applyConfiguration(preset->data, preset->length);
+    }
+  );
+
+  printf("\n%-18s %10.1f ns/call %8.1f allocs/call %8.1f SPI writes/call\n", "applyPreset", result.nsPerCall, result.allocsPerCall, (double)ELECHOUSE_cc1101.writes / next);
+}
+
+// Simulates random bursts against Wake-on-Radio schedules (fraction caught, wake latency, estimated current)
+static void benchSniff() {
+  static const int burstLengthsMs[] = { 30, 100, 400 }; // single frame, short press, typical press w/ repeats
+  std::mt19937 random(433);
+
+  printf("\n%-9s %-8s %-7s %-9s %-9s %-9s %-12s %-10s %-10s\n", "interval", "rx", "duty", "30ms", "100ms", "400ms", "latency(ms)", "mA sleep", "mA awake");
+
+  for (int interval : { 50, 100, 250, 500, 1000 }) {
+    const SniffSchedule schedule = sniffSchedule(interval, SNIFF_RX_TIME);
+    double caught[3] = {};
+    double latencySum = 0;
+    int latencyCount = 0;
+
+    for (int b = 0; b < 3; b++) {
+      std::uniform_int_distribution<long> start(0, 60000000); // one minute
+      const int bursts = 10000;
+
+      for (int i = 0; i < bursts; i++) {
+        long latency;
+        if (!sniffWake(schedule, start(random), burstLengthsMs[b] * 1000L, latency)) continue;
+
+        caught[b] += 100.0 / bursts;
+        latencySum += latency;
+        latencyCount++;
+      }
+    }
+
+    printf("%-9.1f %-8.3f %-7.2f %-9.1f %-9.1f %-9.1f %-12.2f %-10.2f %-10.2f\n", schedule.intervalMs, schedule.rxMs, schedule.dutyCycle * 100,
+      caught[0], caught[1], caught[2], latencyCount > 0 ? latencySum / latencyCount / 1000 : 0, sniffCurrent(schedule, true), sniffCurrent(schedule, false));
+  }
+}
+
+// Princeton capture of one key as the ISR stores it, starting at a random point of the first frame (w/ optional noise
+// pulses that split an edge in two)
+static std::vector<int> captureKey(uint32_t key, int repeats, int glitches, std::mt19937 &random) {
+  std::uniform_int_distribution<int> jitter(-30, 30);
+  std::vector<int> edges = { 1000000 };
+
+  for (int repeat = 0; repeat < repeats; repeat++) {
+    for (int bit = 23; bit >= 0; bit--) {
+      bool one = (key >> bit) & 1;
+      edges.push_back((one ? 1050 : 350) + jitter(random));
+      edges.push_back((one ? 350 : 1050) + jitter(random));
+    }
+
+    edges.push_back(350 + jitter(random));
+    edges.push_back(10850 + jitter(random) * 10);
+  }
+
+  const int skip = std::uniform_int_distribution<int>(0, 24)(random) * 2;
+  edges.erase(edges.begin() + 1, edges.begin() + 1 + skip);
+
+  for (int i = 0; i < glitches; i++) {
+    const int at = std::uniform_int_distribution<int>(2, edges.size() - 1)(random);
+    const int split = edges[at] / 2;
+    edges[at] -= split;
+    edges.insert(edges.begin() + at, { split / 2, split - split / 2 });
+  }
+
+  return edges;
+}
+
+// Same steps as finishRecording(): smoothen, then fingerprint every repeat (a noise pulse only changes a few runs)
+static uint64_t fingerprintCapture(std::vector<int> edges) {
+  std::vector<int> scratch(edges.size());
+  const int length = smoothenBuffer(edges.data(), scratch.data(), edges.size());
+  return fingerprintSamples(edges.data(), length);
+}
+
+// Indexes a full set of keys, then re-captures every one (new jitter, offset and repeat count) and searches for it
+static void benchFingerprint() {
+  std::mt19937 random(36);
+  std::vector<uint32_t> keys(FINGERPRINT_MAX_ENTRIES);
+  std::vector<Fingerprint> index(FINGERPRINT_MAX_ENTRIES);
+
+  for (int i = 0; i < FINGERPRINT_MAX_ENTRIES; i++) {
+    keys[i] = random() & 0xFFFFFF;
+    index[i] = { fingerprintCapture(captureKey(keys[i], 10, 0, random)), 433920000, (uint32_t)i };
+  }
+
+  int found = 0, falseMatches = 0;
+  double sameDistance = 0, otherDistance = 0;
+  long otherPairs = 0;
+  std::vector<Fingerprint> queries(FINGERPRINT_MAX_ENTRIES);
+
+  for (int i = 0; i < FINGERPRINT_MAX_ENTRIES; i++) {
+    queries[i] = { fingerprintCapture(captureKey(keys[i], 3 + random() % 10, i % 2, random)), 433920000, 0 };
+    sameDistance += fingerprintDistance(queries[i].hash, index[i].hash);
+
+    FingerprintMatch matches[FINGERPRINT_MAX_ENTRIES];
+    const int count = findSimilar(index.data(), index.size(), queries[i], matches, FINGERPRINT_MAX_ENTRIES);
+
+    for (int m = 0; m < count; m++) {
+      if (matches[m].id == (uint32_t)i) found++;
+      else if (keys[matches[m].id] != keys[i]) falseMatches++;
+    }
+
+    for (int j = 0; j < FINGERPRINT_MAX_ENTRIES; j += 7) {
+      if (keys[j] == keys[i]) continue;
+      otherDistance += fingerprintDistance(queries[i].hash, index[j].hash);
+      otherPairs++;
+    }
+  }
+
+  int next = 0;
+  Result query = measure(
+    [] {},
+    [&] {
+      FingerprintMatch matches[3];
+      findSimilar(index.data(), index.size(), queries[next++ % FINGERPRINT_MAX_ENTRIES], matches, 3);
+    }
+  );
+
+  printf("\n%-18s %d entries, %zu bytes, %.2f us/query, re-captures found %.1f%%, %d false matches\n", "fingerprint index", FINGERPRINT_MAX_ENTRIES,
+    index.size() * sizeof(Fingerprint), query.nsPerCall / 1000, found * 100.0 / FINGERPRINT_MAX_ENTRIES, falseMatches);
+  printf("%-18s %.1f bits between re-captures, %.1f bits between different keys (similar at <= %d)\n", "", sameDistance / FINGERPRINT_MAX_ENTRIES,
+    otherDistance / otherPairs, FINGERPRINT_MATCH_BITS);
+}
+
+// One frame of the protocol as it's sent (high first), laid out like readFrame() in decoder.cpp expects it
+static void encodeFrame(const Protocol &protocol, uint64_t key, int bits, std::vector<int> &pulses) {
+  const int te = protocol.te;
+  const int longPulse = protocol.te * protocol.ratio;
+
+  if (protocol.layout == LAYOUT_START_PULSE) pulses.push_back(te);
+
+  for (int bit = bits - 1; bit >= 0; bit--) {
+    const bool one = (key >> bit) & 1;
+
+    if (protocol.layout == LAYOUT_START_PULSE) {
+      pulses.push_back(one ? longPulse : te); // (low, high)
+      pulses.push_back(one ? te : longPulse);
+    } else if (protocol.layout == LAYOUT_TRAILING_HIGH && bit == 0) {
+      pulses.push_back(one ? longPulse : te); // the low of the last bit is the gap
+    } else {
+      pulses.push_back(one ? longPulse : te); // (high, low)
+      pulses.push_back(one ? te : longPulse);
+    }
+  }
+
+  if (protocol.layout == LAYOUT_SYNC_PULSE) pulses.push_back(te);
+  pulses.push_back(te * 36);
+}
+
+// Capture of a few repeats of one key w/ 10% timing jitter, glitches split a pulse in two like a noise spike does
+static std::vector<int> captureFrames(const Protocol &protocol, uint64_t key, int bits, int glitches, std::mt19937 &random) {
+  std::uniform_int_distribution<int> jitter(-protocol.te / 10, protocol.te / 10);
+  std::vector<int> frame;
+  encodeFrame(protocol, key, bits, frame);
+
+  std::vector<int> edges = { 1000000 };
+  const int repeats = 3 + random() % 6;
+  for (int repeat = 0; repeat < repeats; repeat++) {
+    for (int pulse : frame) edges.push_back(pulse + jitter(random));
+  }
+
+  for (int i = 0; i < glitches; i++) {
+    const int at = std::uniform_int_distribution<int>(1, edges.size() - 1)(random);
+    const int split = std::uniform_int_distribution<int>(1, edges[at] - 1)(random);
+    edges[at] -= split;
+    edges.insert(edges.begin() + at, { split / 2, split - split / 2 });
+  }
+
+  return edges;
+}
+
+// Runs a capture through the decoder like the main loop does, every reported key is kept
+static std::vector<DecodedSignal> decodeCapture(const std::vector<int> &edges) {
+  Decoder decoder;
+  resetDecoder(decoder);
+
+  std::vector<DecodedSignal> found;
+  DecodedSignal decoded;
+  for (int duration : edges) {
+    if (feedDecoder(decoder, duration, decoded)) found.push_back(decoded);
+  }
+
+  if (flushDecoder(decoder, decoded)) found.push_back(decoded);
+  return found;
+}
+
+// Encodes random keys of every protocol (jitter, half of them w/ a noise glitch) and decodes them again. Decoded is
+// the share of captures the key was read from, false the share that reported any other protocol/key (noise too).
+static void benchDecoder() {
+  const int captures = 500;
+  std::mt19937 random(28);
+
+  printf("\n%-18s %-10s %-10s %-10s %-10s %-12s\n", "decoder corpus", "protocol", "captures", "decoded", "false", "us/capture");
+
+  for (int p = 0; p < numProtocols; p++) {
+    const Protocol &protocol = Protocols[p];
+    int decoded = 0, falseDecodes = 0;
+    std::vector<std::vector<int>> corpus;
+
+    for (int i = 0; i < captures; i++) {
+      const int bits = protocol.minBits + random() % (protocol.maxBits - protocol.minBits + 1);
+      const uint64_t key = (((uint64_t)random() << 32) | random()) & ((1ULL << bits) - 1);
+      corpus.push_back(captureFrames(protocol, key, bits, i % 2, random));
+
+      bool match = false, other = false;
+      for (const DecodedSignal &signal : decodeCapture(corpus.back())) {
+        if (signal.protocol == &protocol && signal.key == key && signal.bits == bits) match = true;
+        else other = true;
+      }
+
+      decoded += match;
+      falseDecodes += other;
+    }
+
+    int next = 0;
+    Result decode = measure([] {}, [&] { decodeCapture(corpus[next++ % captures]); });
+    printf("%-18s %-10s %-10d %-10.1f %-10.1f %-12.2f\n", "", protocol.name, captures, decoded * 100.0 / captures, falseDecodes * 100.0 / captures,
+      decode.nsPerCall / 1000);
+  }
+
+  // Frames of random short/long pulses at a protocol's timing (any length) are noise that should never decode
+  int falseDecodes = 0;
+  for (int i = 0; i < captures; i++) {
+    const Protocol &protocol = Protocols[i % numProtocols];
+    std::uniform_int_distribution<int> jitter(-protocol.te / 10, protocol.te / 10);
+    std::vector<int> edges = { 1000000 };
+
+    for (int frame = 0; frame < 8; frame++) {
+      const int length = 3 + random() % (DECODER_MAX_FRAME - 3);
+      for (int e = 0; e < length; e++) edges.push_back((random() % 2 ? protocol.te * protocol.ratio : protocol.te) + jitter(random));
+      edges.push_back(protocol.te * 36);
+    }
+
+    falseDecodes += !decodeCapture(edges).empty();
+  }
+
+  printf("%-18s %-10s %-10d %-10s %-10.1f\n", "", "noise", captures, "-", falseDecodes * 100.0 / captures);
+}
+
+// Simulated radios on one SPI bus: radio 0 takes an RSSI read for every edge (like the capture interrupt) and
+// retunes now and then, every other radio hops like the frequency analyzer. Hop time shows how bounded retuning stays.
+static void benchRadios() {
+  const Preset* preset = findPreset("AM650");
+  ELECHOUSE_cc1101.spiDelayUs = 2; // about one register access at 4 MHz
+
+  printf("\n%-7s %-6s %-10s %-12s %-10s %-14s %-14s %-11s %-14s\n", "radios", "radio", "role", "trans/sec", "contended", "wait avg/max", "hold avg/max", "rssi stale", "hop avg/max");
+
+  for (int count = 1; count <= 4; count++) {
+    memset(radioStats, 0, sizeof(radioStats));
+    std::atomic<bool> running(true);
+    std::vector<std::thread> threads;
+    std::vector<double> hopSum(count), hopMax(count);
+    std::vector<long> hops(count);
+
+    // Capture: one edge every 200us, a retune every 50ms (starting a recording or replay)
+    threads.emplace_back([&] {
+      unsigned long lastSetup = micros();
+
+      while (running) {
+        if (tryLockRadioFromISR(0)) {
+          ELECHOUSE_cc1101.getRssi();
+          unlockRadioFromISR(0);
+        }
+
+        if (micros() - lastSetup > 50000) {
+          RadioLock lock(0);
+          applyConfiguration(preset->data, preset->length);
+          lastSetup = micros();
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    });
+
+    // Analyzer(s): retune, yield while the RSSI settles, then read it (shares radio 0 if it's the only one)
+    for (int radio = count > 1 ? 1 : 0; radio < count; radio++) {
+      threads.emplace_back([&, radio] {
+        while (running) {
+          const unsigned long started = micros();
+          {
+            RadioLock lock(radio);
+            ELECHOUSE_cc1101.SpiStrobe(CC1101_SIDLE);
+            ELECHOUSE_cc1101.setMHZ(433.92);
+            ELECHOUSE_cc1101.SpiStrobe(CC1101_SRX);
+          }
+          const double hop = micros() - started;
+
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          {
+            RadioLock lock(radio);
+            ELECHOUSE_cc1101.getRssi();
+          }
+
+          hopSum[radio] += hop;
+          hopMax[radio] = std::max(hopMax[radio], hop);
+          hops[radio]++;
+        }
+      });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    running = false;
+    for (std::thread &thread : threads) thread.join();
+
+    for (int radio = 0; radio < count; radio++) {
+      const RadioStats &stats = radioStats[radio];
+      const bool analyzer = count == 1 || radio > 0;
+      char wait[32], hold[32], hop[32];
+
+      snprintf(wait, sizeof(wait), "%lu/%u", stats.transactions ? (unsigned long)(stats.waitUs / stats.transactions) : 0, stats.waitMaxUs);
+      snprintf(hold, sizeof(hold), "%lu/%u", stats.transactions ? (unsigned long)(stats.holdUs / stats.transactions) : 0, stats.holdMaxUs);
+      snprintf(hop, sizeof(hop), analyzer ? "%.0f/%.0f" : "-", hops[radio] ? hopSum[radio] / hops[radio] : 0, hopMax[radio]);
+
+      printf("%-7d %-6d %-10s %-12u %-10u %-14s %-14s %-11u %-14s\n", count, radio, count == 1 ? "both" : analyzer ? "analyzer" : "capture",
+        stats.transactions, stats.contended, wait, hold, stats.rssiStale, hop);
+    }
+  }
+
+  ELECHOUSE_cc1101.spiDelayUs = 0;
+}
+
+#if BENCH_JSON
+// Replies w/o samples, then a long run of mixed commands which shouldn't allocate once the arena exists
+static void benchCommands() {
+  const std::string messages[] = {
+    R"({"url":"/settings","data":{}})",
+    R"({"url":"/metrics","data":{}})",
+    R"({"url":"/subscribe","data":{"topics":["settings","metrics"]}})",
+  };
+
+  for (const std::string &message : messages) {
+    const std::string stage = "dispatch " + message.substr(8, message.find('"', 8) - 8);
+    report(stage.c_str(), "-", 1, measure(
+      [] {},
+      [&] { dispatchCommand(message.c_str(), message.size(), 1); }
+    ));
+  }
+
+  const unsigned long allocated = allocations;
+  const unsigned long replies = repliesSent;
+  const unsigned long bytes = replyBytes;
+  for (int i = 0; i < 10000; i++) {
+    const std::string &message = messages[i % 3];
+    dispatchCommand(message.c_str(), message.size(), 1);
+  }
+
+  printf("\n10000 commands: %lu allocations, %lu replies (%lu bytes), arena peak %u of %zu bytes, %u overflows\n",
+    allocations - allocated, repliesSent - replies, replyBytes - bytes, metrics.commandArenaPeak, COMMAND_ARENA_SIZE, metrics.commandArenaOverflows);
+}
+#endif
+
+int main(int argc, char** argv) {
+  printf("%-18s %-16s %9s %10s %12s %10s\n", "stage", "capture", "edges", "ns/sample", "us/call", "allocs");
+
+  benchCapture("synthetic", syntheticCapture());
+
+  for (int i = 1; i < argc; i++) {
+    std::vector<int> capture;
+    if (!loadCapture(argv[i], capture)) {
+      fprintf(stderr, "Could not read any RAW_Data from %s\n", argv[i]);
+      continue;
+    }
+
+    std::string name = argv[i];
+    benchCapture(name.substr(name.find_last_of('/') + 1), capture);
+  }
+
+  benchPresets();
+  benchSniff();
+  benchRadios();
+  benchFingerprint();
+  benchDecoder();
+
+#if BENCH_JSON
+  benchCommands();
+#else
+  printf("\nArduinoJson was not found, JSON benchmarks were skipped (set ARDUINOJSON_INCLUDE_DIR).\n");
+#endif
+  return 0;
+}
@@ -0,0 +1,48 @@
+// The parts of BKFZ_SubGHz.ino and the transports that the command dispatcher calls, so the JSON benchmarks run the
+// firmware's own commands.cpp, metrics.cpp and user_settings.cpp (replies are only counted, nothing is transmitted)
+
+#include <Arduino.h>
+
+#include <headers/interface.h>
+#include <headers/globals.h>
+#include <headers/config.h>
+
+#include "firmware.h"
+
+int tempSmooth[MAX_SAMPLES];
+int sniffInterval = SNIFF_INTERVAL_MS;
+int sniffRxTime = SNIFF_RX_TIME;
+
+unsigned long repliesSent = 0;
+unsigned long replyBytes = 0;
+
+void sendData(const char* data, size_t length, Topic topic) {
+  (void)data;
+  (void)topic;
+  repliesSent++;
+  replyBytes += length;
+}
+
+void sendData(const String &data, Topic topic) {
+  sendData(data.c_str(), data.length(), topic);
+}
+
+void sendDataTo(const char* data, size_t length, uint32_t client) {
+  (void)client;
+  sendData(data, length, TOPIC_SETTINGS);
+}
+
+void subscribeClient(uint32_t client, uint8_t topics) {
+  (void)client;
+  (void)topics;
+}
+
+void startRecording() {}
+void finishRecording() {}
+void flushSamples() {}
+
+void playSignal(const int *samples, int length, int repeat) {
+  (void)samples;
+  (void)length;
+  (void)repeat;
+}
@@ -0,0 +1,8 @@
+#ifndef BENCH_FIRMWARE_H
+#define BENCH_FIRMWARE_H
+
+// Replies the dispatcher sent through the stubbed transport (see firmware.cpp)
+extern unsigned long repliesSent;
+extern unsigned long replyBytes;
+
+#endif
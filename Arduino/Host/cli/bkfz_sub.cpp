@@ -0,0 +1,424 @@
+// Batch processing of Flipper Zero .sub libraries w/ the same code the firmware runs after a capture
+//
+// Usage: bkfz_sub [-j threads] [--trim] <input dir> <output dir>
+//        bkfz_sub --scale [-j threads] <input dir>
+//
+// Every .sub file below the input directory is smoothened, trimmed to one repeated frame and decoded. Captures w/ the
+// same frame, frequency and preset are duplicates, only the first one (by path) is written to the output directory.
+// Written files repeat the frame as often as it was captured (so a Flipper Zero plays it the same way), w/ --trim they
+// hold the frame once and a "# Repeat:" count like the device sends them.
+// An index.csv w/ the results for every file is written next to them. --scale only processes the tree (nothing is
+// written) w/ 1, 2, 4 ... threads and reports files/s and MB/s for each.
+
+#include <Arduino.h>
+
+#include <headers/processing.h>
+#include <headers/decoder.h>
+
+#include <algorithm>
+#include <climits>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// ---- Work-Stealing Pool ---- //
+
+// Every worker starts w/ a contiguous block of tasks and steals from the back of another block once its own is empty
+struct WorkerQueue {
+  std::mutex lock;
+  std::deque<size_t> tasks;
+};
+
+// Runs task(i) for every i below count, returns how many tasks were stolen
+static unsigned long runParallel(int threads, size_t count, const std::function<void(size_t)> &task) {
+  std::vector<WorkerQueue> queues(threads);
+  for (size_t i = 0; i < count; i++) queues[i * threads / count].tasks.push_back(i);
+
+  std::atomic<unsigned long> steals(0);
+  std::vector<std::thread> workers;
+
+  for (int worker = 0; worker < threads; worker++) {
+    workers.emplace_back([&, worker] {
+      for (;;) {
+        size_t next = 0;
+        bool found = false;
+
+        {
+          std::lock_guard<std::mutex> guard(queues[worker].lock);
+          if (!queues[worker].tasks.empty()) {
+            next = queues[worker].tasks.front();
+            queues[worker].tasks.pop_front();
+            found = true;
+          }
+        }
+
+        for (int offset = 1; offset < threads && !found; offset++) {
+          WorkerQueue &victim = queues[(worker + offset) % threads];
+          std::lock_guard<std::mutex> guard(victim.lock);
+          if (!victim.tasks.empty()) {
+            next = victim.tasks.back();
+            victim.tasks.pop_back();
+            found = true;
+            steals++;
+          }
+        }
+
+        if (!found) return; // nothing is queued after the start, so every queue being empty means we're done
+        task(next);
+      }
+    });
+  }
+
+  for (std::thread &worker : workers) worker.join();
+  return steals;
+}
+
+// ---- Parsing ---- //
+
+// Read-only mapping of a whole file
+class MappedFile {
+  public:
+    explicit MappedFile(const fs::path &path) {
+      int fd = open(path.c_str(), O_RDONLY);
+      if (fd < 0) return;
+
+      struct stat info;
+      if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+          madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+          data = (const char*)mapped;
+          size = info.st_size;
+        }
+      }
+
+      close(fd);
+    }
+
+    ~MappedFile() {
+      if (data != nullptr) munmap((void*)data, size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+struct Capture {
+  int frequency = 0;
+  std::string preset; // BKFZ SubGHz name (AM650, ...)
+  int repeat = 1;
+  std::vector<int> samples; // signed, as stored in RAW_Data
+};
+
+static bool startsWith(const char* at, const char* end, const char* prefix) {
+  size_t length = strlen(prefix);
+  return (size_t)(end - at) >= length && memcmp(at, prefix, length) == 0;
+}
+
+// Parses a signed integer w/o reading past the end of the mapping
+static const char* parseInt(const char* at, const char* end, long &value) {
+  bool negative = at < end && *at == '-';
+  if (negative) at++;
+
+  value = 0;
+  while (at < end && *at >= '0' && *at <= '9') value = value * 10 + (*at++ - '0');
+  if (negative) value = -value;
+  return at;
+}
+
+// Same fields the web interface reads from a SUB file (frequency, preset, repeat count and RAW_Data)
+static bool parseSub(const char* data, size_t size, Capture &capture) {
+  const char* end = data + size;
+
+  for (const char* line = data; line < end;) {
+    const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+    if (lineEnd == nullptr) lineEnd = end;
+
+    long value;
+    if (startsWith(line, lineEnd, "Frequency: ")) {
+      parseInt(line + 11, lineEnd, value);
+      capture.frequency = value;
+    } else if (startsWith(line, lineEnd, "Preset: ")) {
+      std::string preset(line + 8, lineEnd);
+      while (!preset.empty() && (preset.back() == '\r' || preset.back() == ' ')) preset.pop_back();
+      capture.preset = presetFromFlipper(preset.c_str()).str();
+    } else if (startsWith(line, lineEnd, "# Repeat: ")) {
+      parseInt(line + 10, lineEnd, value);
+      if (value > 1) capture.repeat = value;
+    } else if (startsWith(line, lineEnd, "RAW_Data:")) {
+      for (const char* at = line + 9; at < lineEnd;) {
+        if (*at == ' ' || *at == '\r') {
+          at++;
+          continue;
+        }
+
+        const char* next = parseInt(at, lineEnd, value);
+        if (next == at) return false; // not a number
+        if (value != 0) capture.samples.push_back(value);
+        at = next;
+      }
+    }
+
+    line = lineEnd + 1;
+  }
+
+  return !capture.samples.empty();
+}
+
+// ---- Processing ---- //
+
+struct Result {
+  bool ok = false;
+  size_t bytes = 0;
+  int frequency = 0;
+  std::string preset;
+  size_t edges = 0; // RAW_Data values in the input
+  size_t frameEdges = 0; // values written after trimming
+  int repeat = 1;
+  uint64_t hash = 0; // frame (in multiples of its shortest pulse), frequency and preset, duplicates share it
+  std::string protocol;
+  uint64_t key = 0;
+  int bits = 0;
+  std::string sub; // normalized file (only kept when it will be written)
+};
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Smoothens, trims and decodes one file the way finishRecording() does on the device
+static void processFile(const fs::path &path, Result &result, bool keepSub, bool trim) {
+  MappedFile file(path);
+  if (file.data == nullptr) return;
+  result.bytes = file.size;
+
+  Capture capture;
+  if (!parseSub(file.data, file.size, capture)) return;
+
+  // smoothenBuffer() skips the first value (time since boot on the device) and expects unsigned durations
+  const int length = capture.samples.size() + 1;
+  std::vector<int> samples(length), tempSmooth(length);
+  for (int i = 1; i < length; i++) samples[i] = abs(capture.samples[i - 1]);
+
+  const int smoothed = smoothenBuffer(samples.data(), tempSmooth.data(), length);
+
+  int start, frameLength;
+  const int repeat = findRepeatedFrame(samples.data(), smoothed, start, frameLength);
+  const int* frame = samples.data() + start;
+
+  result.frequency = capture.frequency;
+  result.preset = capture.preset;
+  result.edges = capture.samples.size();
+  result.frameEdges = frameLength;
+  result.repeat = repeat * capture.repeat;
+
+  // Smoothened pulses are multiples of one timing that varies a little between captures, gaps are hashed by their sign
+  int shortest = INT_MAX;
+  for (int i = 0; i < frameLength; i++) shortest = std::min(shortest, abs(frame[i]));
+
+  result.hash = 14695981039346656037ull;
+  for (int i = 0; i < frameLength; i++) {
+    int units = abs(frame[i]) >= shortest * REPEAT_GAP ? 0 : (abs(frame[i]) + shortest / 2) / shortest;
+    if (frame[i] < 0) units = -units - 1;
+    result.hash = fnv1a(result.hash, &units, sizeof(units));
+  }
+  result.hash = fnv1a(result.hash, &capture.frequency, sizeof(capture.frequency));
+  result.hash = fnv1a(result.hash, capture.preset.data(), capture.preset.size());
+
+  // Decode the frame between two gaps
+  Decoder decoder;
+  DecodedSignal decoded;
+  resetDecoder(decoder);
+  feedDecoder(decoder, DECODER_GAP, decoded);
+
+  bool found = false;
+  for (int pass = 0; pass < 2 && !found; pass++) {
+    for (int i = 0; i < frameLength && !found; i++) found = feedDecoder(decoder, frame[i], decoded);
+    if (!found) found = flushDecoder(decoder, decoded);
+  }
+
+  if (found) {
+    result.protocol = decoded.protocol->name;
+    result.key = decoded.key;
+    result.bits = decoded.bits;
+  }
+
+  if (keepSub) result.sub = buildSubFile(frame, frameLength, capture.preset.c_str(), capture.frequency, result.repeat, trim).str() + "\n";
+  result.ok = true;
+}
+
+static std::vector<fs::path> findSubFiles(const fs::path &root) {
+  std::vector<fs::path> files;
+  for (const fs::directory_entry &entry : fs::recursive_directory_iterator(root)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".sub") files.push_back(entry.path());
+  }
+
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+// ---- Commands ---- //
+
+static int processTree(const fs::path &input, const fs::path &output, int threads, bool trim) {
+  const std::vector<fs::path> files = findSubFiles(input);
+  std::vector<Result> results(files.size());
+
+  const auto started = std::chrono::steady_clock::now();
+  runParallel(threads, files.size(), [&](size_t i) { processFile(files[i], results[i], true, trim); });
+
+  // The first file (by path) w/ a frame is the original, so the output doesn't depend on the thread count
+  std::map<uint64_t, size_t> originals;
+  std::vector<long> duplicateOf(files.size(), -1);
+  for (size_t i = 0; i < files.size(); i++) {
+    if (!results[i].ok) continue;
+
+    auto inserted = originals.emplace(results[i].hash, i);
+    if (!inserted.second) duplicateOf[i] = inserted.first->second;
+  }
+
+  std::atomic<unsigned long> failedWrites(0);
+  runParallel(threads, files.size(), [&](size_t i) {
+    if (!results[i].ok || duplicateOf[i] >= 0) return;
+
+    const fs::path target = output / fs::relative(files[i], input);
+    std::error_code error;
+    fs::create_directories(target.parent_path(), error);
+
+    std::ofstream file(target, std::ios::binary);
+    file.write(results[i].sub.data(), results[i].sub.size());
+    if (!file) failedWrites++;
+  });
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  // One line per file, in path order
+  std::ofstream index(output / "index.csv");
+  index << "path,frequency,preset,edges,frame_edges,repeat,duplicate_of,protocol,key,bits\n";
+
+  size_t processed = 0, duplicates = 0, decoded = 0, bytes = 0, edges = 0, frameEdges = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    const Result &result = results[i];
+    bytes += result.bytes;
+
+    const std::string path = fs::relative(files[i], input).string();
+    if (!result.ok) {
+      fprintf(stderr, "Could not read any RAW_Data from %s\n", path.c_str());
+      continue;
+    }
+
+    processed++;
+    edges += result.edges;
+    frameEdges += result.frameEdges;
+    if (duplicateOf[i] >= 0) duplicates++;
+    if (!result.protocol.empty()) decoded++;
+
+    char key[17] = "";
+    if (!result.protocol.empty()) snprintf(key, sizeof(key), "%llX", (unsigned long long)result.key);
+
+    index << path << ',' << result.frequency << ',' << result.preset << ',' << result.edges << ',' << result.frameEdges << ','
+      << result.repeat << ',' << (duplicateOf[i] >= 0 ? fs::relative(files[duplicateOf[i]], input).string() : "") << ','
+      << result.protocol << ',' << key << ',' << (result.protocol.empty() ? 0 : result.bits) << '\n';
+  }
+
+  printf("%zu files (%zu unreadable), %zu duplicates, %zu decoded\n", processed, files.size() - processed, duplicates, decoded);
+  printf("%zu edges trimmed to %zu (%.1f%%)\n", edges, frameEdges, edges > 0 ? frameEdges * 100.0 / edges : 0);
+  printf("%.3fs w/ %d threads, %.0f files/s, %.1f MB/s\n", seconds, threads, files.size() / seconds, bytes / seconds / 1e6);
+
+  if (failedWrites > 0) {
+    fprintf(stderr, "%lu files could not be written to %s\n", (unsigned long)failedWrites, output.c_str());
+    return 1;
+  }
+  return 0;
+}
+
+static int scaleTree(const fs::path &input, int maxThreads) {
+  const std::vector<fs::path> files = findSubFiles(input);
+  if (files.empty()) {
+    fprintf(stderr, "No .sub files found in %s\n", input.c_str());
+    return 1;
+  }
+
+  std::vector<int> counts;
+  for (int threads = 1; threads < maxThreads; threads *= 2) counts.push_back(threads);
+  counts.push_back(maxThreads);
+
+  printf("%-8s %10s %10s %10s %8s %8s\n", "threads", "seconds", "files/s", "MB/s", "speedup", "steals");
+  double baseline = 0;
+
+  for (int threads : counts) {
+    std::vector<Result> results(files.size());
+    const auto started = std::chrono::steady_clock::now();
+    const unsigned long steals = runParallel(threads, files.size(), [&](size_t i) { processFile(files[i], results[i], false, false); });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    size_t bytes = 0;
+    for (const Result &result : results) bytes += result.bytes;
+    if (baseline == 0) baseline = seconds;
+
+    printf("%-8d %10.3f %10.0f %10.1f %8.2f %8lu\n", threads, seconds, files.size() / seconds, bytes / seconds / 1e6, baseline / seconds, steals);
+  }
+
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  bool scale = false;
+  bool trim = false;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+
+    if (arg == "--scale") {
+      scale = true;
+    } else if (arg == "--trim") {
+      trim = true;
+    } else if (arg == "-j" && i + 1 < argc) {
+      threads = std::max(1, atoi(argv[++i]));
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  if (paths.size() != (scale ? 1u : 2u) || !fs::is_directory(paths[0])) {
+    fprintf(stderr, "Usage: %s [-j threads] [--trim] <input dir> <output dir>\n       %s --scale [-j threads] <input dir>\n", argv[0], argv[0]);
+    return 1;
+  }
+
+  if (scale) return scaleTree(paths[0], threads);
+
+  const fs::path output = paths[1];
+  std::error_code error;
+  fs::create_directories(output, error);
+  if (error) {
+    fprintf(stderr, "Could not create %s\n", output.c_str());
+    return 1;
+  }
+
+  return processTree(paths[0], output, threads, trim);
+}
@@ -0,0 +1,324 @@
+#!/usr/bin/env python3
+# Load tests against a BKFZ SubGHz running in Wi-Fi mode (only the Python standard library is needed)
+#
+# Usage: load_test.py ws [--host 192.168.4.1] [--seconds 30] [--pages record,analyzer,settings,home] [--broadcast]
+#        load_test.py http [--host 192.168.4.1] [--parallel 10] [--rounds 20] [--revalidate]
+#        load_test.py commands [--host 192.168.4.1] [--count 10000]
+#
+# ws opens one websocket per page, subscribed to the same topics as that page, and counts the bytes every client
+# receives. --broadcast subscribes every client to every topic, which is what every socket received before topics
+# existed, so running it once w/ and once w/o --broadcast compares the old and new traffic. The frequency analyzer
+# is started for the run (--start record also starts a recording, that needs a second CC1101 module).
+#
+# http requests every page from --parallel connections at once and reports the time to first byte and the total time
+# per page. --revalidate sends the ETag of the first response back w/ If-None-Match (the 304 path). Free heap is read
+# from /api/metrics before and after the run, the lowest free heap since boot shows how much the requests needed.
+# Requesting /analyzer starts the frequency analyzer, the same as opening the page does.
+#
+# commands sends --count websocket commands (settings reads, metrics reads and subscriptions, each reply is waited for)
+# and compares the free heap the device saw after the first and the latest command. Every command is parsed and
+# answered from the command arena, so both values should match and arena_overflows should stay at 0.
+
+import argparse
+import base64
+import json
+import os
+import queue
+import socket
+import struct
+import threading
+import time
+import urllib.request
+
+# Same topics as pageTopics in data/assets/websockets.js
+PAGE_TOPICS = {
+    "record": ["record-telemetry", "record-result"],
+    "analyzer": ["analyzer"],
+    "play": [],
+    "settings": [],
+    "home": [],
+}
+
+ALL_TOPICS = ["analyzer", "record-telemetry", "record-result", "play-status", "settings", "metrics"]
+
+
+class WebSocket:
+    """Just enough of RFC 6455 for text messages to and from the device."""
+
+    def __init__(self, host, port, path="/ws"):
+        self.sock = socket.create_connection((host, port), timeout=10)
+        key = base64.b64encode(os.urandom(16)).decode()
+        request = (
+            f"GET {path} HTTP/1.1\r\nHost: {host}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+            f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n"
+        )
+        self.sock.sendall(request.encode())
+
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("connection closed during the websocket handshake")
+            response += chunk
+
+        header, self.buffer = response.split(b"\r\n\r\n", 1)
+        if b" 101 " not in header.split(b"\r\n")[0]:
+            raise ConnectionError(header.split(b"\r\n")[0].decode())
+
+    def send(self, message):
+        payload = json.dumps(message).encode()
+        mask = os.urandom(4)
+        length = len(payload)
+
+        if length < 126:
+            header = struct.pack("!BB", 0x81, 0x80 | length)
+        elif length < 65536:
+            header = struct.pack("!BBH", 0x81, 0x80 | 126, length)
+        else:
+            header = struct.pack("!BBQ", 0x81, 0x80 | 127, length)
+
+        self.sock.sendall(header + mask + bytes(b ^ mask[i % 4] for i, b in enumerate(payload)))
+
+    def _read(self, count):
+        while len(self.buffer) < count:
+            chunk = self.sock.recv(65536)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            self.buffer += chunk
+
+        data, self.buffer = self.buffer[:count], self.buffer[count:]
+        return data
+
+    def receive(self):
+        """Returns (opcode, payload) of the next frame, the device never fragments or masks its frames."""
+        first, second = self._read(2)
+        length = second & 0x7F
+        if length == 126:
+            length = struct.unpack("!H", self._read(2))[0]
+        elif length == 127:
+            length = struct.unpack("!Q", self._read(8))[0]
+
+        return first & 0x0F, self._read(length)
+
+    def close(self):
+        try:
+            self.sock.sendall(struct.pack("!BB", 0x88, 0x80) + os.urandom(4))
+        except OSError:
+            pass
+        self.sock.close()
+
+
+def get_json(host, port, path):
+    with urllib.request.urlopen(f"http://{host}:{port}{path}", timeout=10) as response:
+        return json.load(response)
+
+
+def run_ws(args):
+    pages = args.pages.split(",")
+    received = [0] * len(pages)
+    messages = [0] * len(pages)
+    running = True
+
+    def listen(index, client):
+        client.sock.settimeout(0.5)
+        while running:
+            try:
+                opcode, payload = client.receive()
+            except socket.timeout:
+                continue
+            except (ConnectionError, OSError):
+                return
+
+            if opcode == 0x1:
+                received[index] += len(payload)
+                messages[index] += 1
+
+    clients = []
+    for index, page in enumerate(pages):
+        client = WebSocket(args.host, args.port)
+        client.send({"url": "/subscribe", "data": {"topics": ALL_TOPICS if args.broadcast else PAGE_TOPICS.get(page, [])}})
+        clients.append(client)
+
+    threads = [threading.Thread(target=listen, args=(i, c), daemon=True) for i, c in enumerate(clients)]
+    for thread in threads:
+        thread.start()
+
+    for target in args.start:
+        clients[0].send({"url": f"/{target}", "data": {"active": True}})
+
+    before = get_json(args.host, args.port, "/api/metrics")["transport"]
+    started = time.monotonic()
+    time.sleep(args.seconds)
+    elapsed = time.monotonic() - started
+    after = get_json(args.host, args.port, "/api/metrics")["transport"]
+
+    for target in args.start:
+        clients[0].send({"url": f"/{target}", "data": {"active": False}})
+
+    running = False
+    for thread in threads:
+        thread.join()
+    for client in clients:
+        client.close()
+
+    mode = "broadcast (every topic)" if args.broadcast else "subscribed (page topics)"
+    print(f"{mode}, {len(pages)} clients, {elapsed:.1f}s")
+    print(f"{'page':<10} {'messages':>9} {'bytes/s':>10}")
+    for page, count, size in zip(pages, messages, received):
+        print(f"{page:<10} {count:>9} {size / elapsed:>10.0f}")
+
+    print(f"{'total':<10} {sum(messages):>9} {sum(received) / elapsed:>10.0f}")
+    print(f"device queued {(after['bytes'] - before['bytes']) / elapsed:.0f} bytes/s, deepest client queue {after['queue_depth_max']}")
+
+
+PAGES = ["/", "/record", "/play", "/analyzer", "/settings", "/settings.js"]
+
+
+def fetch(host, port, path, etag=None):
+    """Returns (status, etag, time to first byte, total time) of one request on its own connection."""
+    headers = f"GET {path} HTTP/1.1\r\nHost: {host}\r\nConnection: close\r\n"
+    if etag:
+        headers += f"If-None-Match: {etag}\r\n"
+
+    started = time.monotonic()
+    with socket.create_connection((host, port), timeout=10) as sock:
+        sock.sendall((headers + "\r\n").encode())
+        response = sock.recv(65536)
+        first = time.monotonic()
+
+        while True:
+            chunk = sock.recv(65536)
+            if not chunk:
+                break
+            response += chunk
+
+    header = response.split(b"\r\n\r\n", 1)[0].decode(errors="replace").split("\r\n")
+    status = int(header[0].split(" ")[1])
+    tag = next((line.split(":", 1)[1].strip() for line in header[1:] if line.lower().startswith("etag:")), None)
+    return status, tag, first - started, time.monotonic() - started
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * fraction))] if ordered else 0
+
+
+def run_http(args):
+    etags = {}
+    if args.revalidate:
+        for path in PAGES:
+            etags[path] = fetch(args.host, args.port, path)[1]
+
+    tasks = queue.Queue()
+    for _ in range(args.rounds):
+        for path in PAGES:
+            tasks.put(path)
+
+    results = {path: [] for path in PAGES}
+    errors = {path: 0 for path in PAGES}
+    statuses = {path: set() for path in PAGES}
+    lock = threading.Lock()
+
+    def worker():
+        while True:
+            try:
+                path = tasks.get_nowait()
+            except queue.Empty:
+                return
+
+            try:
+                status, _, ttfb, total = fetch(args.host, args.port, path, etags.get(path))
+                with lock:
+                    results[path].append((ttfb, total))
+                    statuses[path].add(status)
+            except (OSError, ValueError, IndexError):
+                with lock:
+                    errors[path] += 1
+
+    before = get_json(args.host, args.port, "/api/metrics")["memory"]
+    started = time.monotonic()
+    threads = [threading.Thread(target=worker) for _ in range(args.parallel)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.monotonic() - started
+    after = get_json(args.host, args.port, "/api/metrics")["memory"]
+
+    print(f"{args.parallel} parallel connections, {args.rounds} rounds, {elapsed:.1f}s" + (" (If-None-Match)" if args.revalidate else ""))
+    print(f"{'page':<14} {'status':<8} {'requests':>8} {'errors':>6} {'ttfb p50':>9} {'ttfb p95':>9} {'ttfb max':>9} {'total p50':>10}")
+    for path in PAGES:
+        ttfb = [r[0] * 1000 for r in results[path]]
+        total = [r[1] * 1000 for r in results[path]]
+        status = ",".join(str(s) for s in sorted(statuses[path])) or "-"
+        print(f"{path:<14} {status:<8} {len(ttfb):>8} {errors[path]:>6} {percentile(ttfb, 0.5):>7.1f}ms {percentile(ttfb, 0.95):>7.1f}ms "
+              f"{max(ttfb, default=0):>7.1f}ms {percentile(total, 0.5):>8.1f}ms")
+
+    print(f"heap free {before['heap_free']} before, {after['heap_free']} after, lowest since boot {after['heap_min_free']} "
+          f"(largest block {after['heap_max_block']})")
+
+
+# Commands sent in turn by the commands test, the ones w/ a reply are waited for
+COMMANDS = [
+    ({"url": "/settings", "data": {}}, True),
+    ({"url": "/metrics", "data": {}}, True),
+    ({"url": "/subscribe", "data": {"topics": ["settings", "metrics"]}}, False),
+]
+
+
+def run_commands(args):
+    client = WebSocket(args.host, args.port)
+    client.send({"url": "/subscribe", "data": {"topics": ["settings", "metrics"]}})
+    before = get_json(args.host, args.port, "/api/metrics")
+
+    started = time.monotonic()
+    for index in range(args.count):
+        message, reply = COMMANDS[index % len(COMMANDS)]
+        client.send(message)
+        while reply and client.receive()[0] != 0x1:
+            pass
+
+    elapsed = time.monotonic() - started
+    client.close()
+    after = get_json(args.host, args.port, "/api/metrics")
+
+    commands = after["commands"]
+    print(f"{args.count} commands in {elapsed:.1f}s ({args.count / elapsed:.0f}/s), {commands['count'] - before['commands']['count']} handled, "
+          f"{commands['errors'] - before['commands']['errors']} errors")
+    print(f"heap free after the first command {commands['heap_free_first']}, after the latest {commands['heap_free_last']} "
+          f"({commands['heap_free_last'] - commands['heap_free_first']:+d}), lowest since boot {after['memory']['heap_min_free']}")
+    print(f"arena peak {commands['arena_peak']} of {commands['arena_bytes']} bytes, {commands['arena_overflows']} overflows")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Load tests against a BKFZ SubGHz in Wi-Fi mode")
+    parser.add_argument("--host", default="192.168.4.1")
+    parser.add_argument("--port", type=int, default=80)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    ws = commands.add_parser("ws", help="websocket bytes/s w/ a mix of pages open")
+    ws.add_argument("--seconds", type=float, default=30)
+    ws.add_argument("--pages", default="record,analyzer,settings,home")
+    ws.add_argument("--broadcast", action="store_true", help="subscribe every client to every topic (old behaviour)")
+    ws.add_argument("--start", action="append", choices=["analyzer", "record"], help="activity to run during the test (default: analyzer)")
+
+    http = commands.add_parser("http", help="time to first byte and heap under parallel page requests")
+    http.add_argument("--parallel", type=int, default=10)
+    http.add_argument("--rounds", type=int, default=20, help="requests per page")
+    http.add_argument("--revalidate", action="store_true", help="send the ETag back w/ If-None-Match")
+
+    command = commands.add_parser("commands", help="free heap over many websocket commands")
+    command.add_argument("--count", type=int, default=10000)
+
+    args = parser.parse_args()
+    if args.command == "ws":
+        args.start = args.start or ["analyzer"]
+        run_ws(args)
+    elif args.command == "http":
+        run_http(args)
+    else:
+        run_commands(args)
+
+
+if __name__ == "__main__":
+    main()
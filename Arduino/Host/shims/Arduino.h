@@ -0,0 +1,128 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal stand-in for the Arduino core so the signal processing files can be built on Linux
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#define F(string_literal) (string_literal)
+
+using std::min;
+using std::max;
+
+inline unsigned long micros() {
+  static const auto boot = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+}
+
+inline unsigned long millis() {
+  return micros() / 1000;
+}
+
+// Arduino String backed by std::string (only what the shared files use)
+class String {
+  public:
+    String() {}
+    String(const char* value) : data(value ? value : "") {}
+    String(const std::string &value) : data(value) {}
+    String(const char* value, size_t length) : data(value, length) {}
+    explicit String(char value) : data(1, value) {}
+    explicit String(int value, int base = 10) : data(toBase((long long)value, base)) {}
+    explicit String(unsigned int value, int base = 10) : data(toBase((long long)value, base)) {}
+    explicit String(long value, int base = 10) : data(toBase((long long)value, base)) {}
+    explicit String(unsigned long value, int base = 10) : data(toBase((long long)value, base)) {}
+
+    const char* c_str() const { return data.c_str(); }
+    unsigned int length() const { return data.length(); }
+    bool isEmpty() const { return data.empty(); }
+    void clear() { data.clear(); }
+    void reserve(size_t size) { data.reserve(size); }
+    const std::string &str() const { return data; }
+
+    String &operator+=(const String &other) { data += other.data; return *this; }
+    String &operator+=(const char* other) { data += other; return *this; }
+    String &operator+=(char other) { data += other; return *this; }
+    bool concat(const char* other) { data += other; return true; }
+    bool concat(const String &other) { data += other.data; return true; }
+
+    bool operator==(const String &other) const { return data == other.data; }
+    bool operator==(const char* other) const { return data == other; }
+    bool operator!=(const String &other) const { return data != other.data; }
+    bool operator!=(const char* other) const { return data != other; }
+    char operator[](unsigned int index) const { return data[index]; }
+
+    void replace(const String &find, const String &replacement) {
+      if (find.data.empty()) return;
+
+      for (size_t at = data.find(find.data); at != std::string::npos; at = data.find(find.data, at + replacement.data.size())) {
+        data.replace(at, find.data.size(), replacement.data);
+      }
+    }
+
+    int indexOf(const String &find, unsigned int from = 0) const {
+      size_t at = data.find(find.data, from);
+      return at == std::string::npos ? -1 : (int)at;
+    }
+
+    String substring(unsigned int from, unsigned int to) const { return from >= data.size() ? String() : String(data.substr(from, to - from)); }
+    String substring(unsigned int from) const { return from >= data.size() ? String() : String(data.substr(from)); }
+    bool startsWith(const String &prefix) const { return data.compare(0, prefix.data.size(), prefix.data) == 0; }
+    bool endsWith(const String &suffix) const { return data.size() >= suffix.data.size() && data.compare(data.size() - suffix.data.size(), suffix.data.size(), suffix.data) == 0; }
+    long toInt() const { return atol(data.c_str()); }
+
+    void trim() {
+      size_t first = data.find_first_not_of(" \t\r\n");
+      size_t last = data.find_last_not_of(" \t\r\n");
+      data = first == std::string::npos ? std::string() : data.substr(first, last - first + 1);
+    }
+
+  private:
+    std::string data;
+
+    static std::string toBase(long long value, int base) {
+      if (base == 10) return std::to_string(value);
+
+      std::string digits;
+      unsigned long long remaining = (unsigned long long)value;
+      do {
+        digits.insert(digits.begin(), "0123456789ABCDEF"[remaining % base]);
+        remaining /= base;
+      } while (remaining > 0);
+      return digits;
+    }
+};
+
+inline String operator+(const String &left, const String &right) { String result(left); result += right; return result; }
+inline String operator+(const String &left, const char* right) { String result(left); result += right; return result; }
+inline String operator+(const char* left, const String &right) { String result(left); result += right; return result; }
+
+// Serial output is dropped on the host (the command handlers log to it)
+struct HostSerial {
+  template <typename T> void print(const T &) {}
+  template <typename T> void println(const T &) {}
+  void println() {}
+  int printf(const char* format, ...) { (void)format; return 0; }
+};
+
+inline HostSerial Serial;
+
+// Heap and task queries read by the metrics (the host has neither, so they report 0 and no tasks)
+struct HostEsp {
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+  uint32_t getMaxAllocHeap() { return 0; }
+};
+
+inline HostEsp ESP;
+
+typedef void* TaskHandle_t;
+typedef uint32_t StackType_t;
+inline TaskHandle_t xTaskGetHandle(const char* name) { (void)name; return nullptr; }
+inline unsigned uxTaskGetStackHighWaterMark(TaskHandle_t task) { (void)task; return 0; }
+
+#endif
@@ -0,0 +1,12 @@
+#include "ELECHOUSE_CC1101_SRC_DRV.h"
+#include "Arduino.h"
+
+ELECHOUSE_CC1101 ELECHOUSE_cc1101;
+
+// Busy-waits like a real transfer would, so simulated radios contend for the bus
+void ELECHOUSE_CC1101::transfer() {
+  if (spiDelayUs == 0) return;
+
+  const unsigned long started = micros();
+  while (micros() - started < spiDelayUs) {}
+}
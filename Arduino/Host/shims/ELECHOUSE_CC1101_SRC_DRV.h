@@ -0,0 +1,90 @@
+#ifndef HOST_ELECHOUSE_CC1101_SRC_DRV_H
+#define HOST_ELECHOUSE_CC1101_SRC_DRV_H
+
+// Mock CC1101 driver, register writes only land in a local register file (per module)
+
+#include <stdint.h>
+
+/* CC1101 Configuration Registers */
+#define CC1101_IOCFG2   0x00
+#define CC1101_IOCFG1   0x01
+#define CC1101_IOCFG0   0x02
+#define CC1101_FIFOTHR  0x03
+#define CC1101_SYNC1    0x04
+#define CC1101_SYNC0    0x05
+#define CC1101_PKTLEN   0x06
+#define CC1101_PKTCTRL1 0x07
+#define CC1101_PKTCTRL0 0x08
+#define CC1101_ADDR     0x09
+#define CC1101_CHANNR   0x0A
+#define CC1101_FSCTRL1  0x0B
+#define CC1101_FSCTRL0  0x0C
+#define CC1101_FREQ2    0x0D
+#define CC1101_FREQ1    0x0E
+#define CC1101_FREQ0    0x0F
+#define CC1101_MDMCFG4  0x10
+#define CC1101_MDMCFG3  0x11
+#define CC1101_MDMCFG2  0x12
+#define CC1101_MDMCFG1  0x13
+#define CC1101_MDMCFG0  0x14
+#define CC1101_DEVIATN  0x15
+#define CC1101_MCSM2    0x16
+#define CC1101_MCSM1    0x17
+#define CC1101_MCSM0    0x18
+#define CC1101_FOCCFG   0x19
+#define CC1101_BSCFG    0x1A
+#define CC1101_AGCCTRL2 0x1B
+#define CC1101_AGCCTRL1 0x1C
+#define CC1101_AGCCTRL0 0x1D
+#define CC1101_WOREVT1  0x1E
+#define CC1101_WOREVT0  0x1F
+#define CC1101_WORCTRL  0x20
+#define CC1101_FREND1   0x21
+#define CC1101_FREND0   0x22
+
+/* CC1101 Command Strobes */
+#define CC1101_SRES     0x30
+#define CC1101_SRX      0x34
+#define CC1101_STX      0x35
+#define CC1101_SIDLE    0x36
+#define CC1101_SWOR     0x38
+#define CC1101_SPWD     0x39
+#define CC1101_SWORRST  0x3C
+
+class ELECHOUSE_CC1101 {
+  public:
+    uint8_t registers[6][0x40] = {}; // one register file per module (selected w/ setModul)
+    int modul = 0;
+    unsigned long writes = 0; // register writes since the last reset of the counter
+    unsigned long strobes = 0;
+    unsigned long spiDelayUs = 0; // simulated time of one SPI transfer (0 = instant)
+
+    void addSpiPin(uint8_t sck, uint8_t miso, uint8_t mosi, uint8_t ss, uint8_t module) { (void)sck; (void)miso; (void)mosi; (void)ss; (void)module; }
+    void addGDO(uint8_t gdo0, uint8_t gdo2, uint8_t module) { (void)gdo0; (void)gdo2; (void)module; }
+    void setModul(uint8_t module) { modul = module; }
+
+    void SpiWriteReg(uint8_t addr, uint8_t value) {
+      transfer();
+      registers[modul][addr & 0x3F] = value;
+      writes++;
+    }
+
+    uint8_t SpiReadReg(uint8_t addr) { transfer(); return registers[modul][addr & 0x3F]; }
+    void SpiStrobe(uint8_t strobe) { (void)strobe; transfer(); strobes++; }
+    int getRssi() { transfer(); return -60; }
+
+    // Writes the frequency registers (the real driver also rewrites the calibration registers afterwards)
+    void setMHZ(float mhz) {
+      const uint32_t freq = (uint32_t)(mhz * 65536.0f / 26.0f);
+      SpiWriteReg(CC1101_FREQ2, freq >> 16);
+      SpiWriteReg(CC1101_FREQ1, freq >> 8);
+      SpiWriteReg(CC1101_FREQ0, freq);
+    }
+
+  private:
+    void transfer();
+};
+
+extern ELECHOUSE_CC1101 ELECHOUSE_cc1101;
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// Mock non-volatile storage, nothing is kept (every read returns the default)
+
+#include "Arduino.h"
+
+class Preferences {
+  public:
+    bool begin(const char* name, bool readOnly = false) { (void)name; (void)readOnly; return true; }
+    void end() {}
+
+    int getInt(const char* key, int defaultValue = 0) { (void)key; return defaultValue; }
+    String getString(const char* key, const String &defaultValue = String()) { (void)key; return defaultValue; }
+    size_t putInt(const char* key, int value) { (void)key; (void)value; return sizeof(int); }
+    size_t putString(const char* key, const String &value) { (void)key; return value.length(); }
+};
+
+#endif